@@ -14,6 +14,133 @@ auto Client::runConnection() -> void {
     client_context.run();
 }
 
+// =======================================================================
+auto Client::setState(ClientState state) -> void {
+    currentState = state ;
+    if (stateCallback != nullptr) {
+        stateCallback(this->shared_from_this(),state) ;
+    }
+}
+
+// =======================================================================
+auto Client::beginResolve() -> void {
+    if (!running) {
+        return ;
+    }
+    setState(ClientState::RESOLVING) ;
+    resolver.async_resolve(asio::ip::tcp::v4(), serverName, std::to_string(serverPort), std::bind(&Client::resolveHandler,this,std::placeholders::_1,std::placeholders::_2)) ;
+}
+
+// =======================================================================
+auto Client::resolveHandler(const asio::error_code &ec, asio::ip::tcp::resolver::results_type results) -> void {
+    if (!running || ec == asio::error::operation_aborted) {
+        return ;
+    }
+    if (ec || results.empty()) {
+        DBGMSG(std::cerr, "Unable to resolve: "s + serverName + " : "s + std::to_string(serverPort)) ;
+        if (cachedEndpoint == asio::ip::tcp::endpoint()) {
+            scheduleRetry() ;
+            return ;
+        }
+        // Use what we had the last time
+    }
+    else {
+        cachedEndpoint = results.begin()->endpoint() ;
+    }
+    beginConnect() ;
+}
+
+// =======================================================================
+auto Client::beginConnect() -> void {
+    if (!running || connection->is_open()) {
+        return ;
+    }
+    if (cachedEndpoint == asio::ip::tcp::endpoint()) {
+        beginResolve() ;
+        return ;
+    }
+    setState(ClientState::CONNECTING) ;
+    auto port = (useEphemeral ? std::uint16_t(0) : bindPort) ;
+    if (!connection->open(port)) {
+        if (!bindFallback || port == 0 || !connection->open(0)) {
+            scheduleRetry() ;
+            return ;
+        }
+    }
+    connectTimer.expires_after(CONNECTTIMEOUT) ;
+    connectTimer.async_wait([this](const asio::error_code &ec){
+        if (!ec) {
+            // Took too long, closing it will complete the connect with an error
+            connection->close() ;
+        }
+    });
+    connection->connect(cachedEndpoint, std::bind(&Client::connectHandler,this,std::placeholders::_1)) ;
+}
+
+// =======================================================================
+auto Client::connectHandler(const asio::error_code &ec) -> void {
+    asio::error_code ignore ;
+    connectTimer.cancel(ignore) ;
+    if (!running) {
+        connection->close() ;
+        return ;
+    }
+    if (ec) {
+        DBGMSG(std::cerr, "Unable to connect: "s + ec.message()) ;
+        if (bindFallback && bindPort != 0 && (ec == asio::error::address_in_use || ec == std::errc::address_not_available)) {
+            // Our bind port is still held by the last connection
+            useEphemeral = true ;
+        }
+        else {
+            // Maybe the server moved
+            cachedEndpoint = asio::ip::tcp::endpoint() ;
+        }
+        scheduleRetry() ;
+        return ;
+    }
+    connected() ;
+}
+
+// =======================================================================
+auto Client::scheduleRetry() -> void {
+    if (!running) {
+        return ;
+    }
+    setState(ClientState::WAITING) ;
+    // Jitter by +/- 25%, so a yard full of clients does not all hit a restarted server at once
+    auto spread = std::uniform_int_distribution<std::int64_t>(-backoff.count()/4, backoff.count()/4) ;
+    auto delay = backoff + std::chrono::milliseconds(spread(jitter)) ;
+    backoff = std::min(backoff * 2, std::chrono::duration_cast<std::chrono::milliseconds>(MAXBACKOFF)) ;
+    retryTimer.expires_after(delay) ;
+    retryTimer.async_wait([this](const asio::error_code &ec){
+        if (!ec) {
+            beginConnect() ;
+        }
+    });
+}
+
+// =======================================================================
+auto Client::connected() -> void {
+    backoff = MINBACKOFF ;
+    useEphemeral = false ;
+    reconnectDuration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - disconnectTime).count() ;
+    DBGMSG(std::cout, "Connected to "s + connection->peer() + " in "s + std::to_string(reconnectDuration.load()) + " ms"s);
+    
+    connection->clearReadTime();
+    connection->clearWriteTime() ;
+    
+    syncChannel->setServer(cachedEndpoint.address()) ;
+    auto packet = IdentPacket(connection->handle, syncChannel->port(), capabilities) ;
+    connection->send(packet) ;
+    setState(ClientState::CONNECTED) ;
+    if (connectBeforeRead != nullptr){
+        connectBeforeRead(this->shared_from_this());
+    }
+    connection->read() ;
+    startProbe() ;
+    startStats() ;
+}
+
 // =======================================================================
 auto Client::closeCallback(ConnectionPointer conn) -> void {
     // anything we need to do ?
@@ -25,13 +152,105 @@ auto Client::closeCallback(ConnectionPointer conn) -> void {
         connection->shutdown() ;
     }
     catch(...){}
+    disconnectTime = std::chrono::steady_clock::now() ;
+    asio::error_code ec ;
+    probeTimer.cancel(ec) ;
+    statsTimer.cancel(ec) ;
+    if (running) {
+        // Try right away, the backoff takes over if the server is not there yet
+        backoff = MINBACKOFF ;
+        setState(ClientState::WAITING) ;
+        asio::post(client_context,std::bind(&Client::beginConnect,this)) ;
+    }
 }
+// =======================================================================
+auto Client::startProbe() -> void {
+    probeOutstanding = false ;
+    latencyEstimator.clear() ;
+    probeRun += 1 ;
+    asio::error_code ec ;
+    probeTimer.cancel(ec) ;
+    if (probeInterval <= 0) {
+        return ;
+    }
+    asio::co_spawn(client_context, this->probeLoop(probeRun), asio::detached) ;
+}
+
+// =======================================================================
+auto Client::probeLoop(std::uint64_t run) -> asio::awaitable<void> {
+    // Get an estimate as soon as we can, and then settle into the interval
+    auto wait = std::chrono::steady_clock::duration(std::chrono::milliseconds(100)) ;
+    while (true) {
+        asio::error_code ec ;
+        probeTimer.expires_after(wait) ;
+        co_await probeTimer.async_wait(asio::redirect_error(asio::use_awaitable, ec)) ;
+        if (ec == asio::error::operation_aborted || run != probeRun || probeInterval <= 0 || connection == nullptr || !connection->is_open()) {
+            co_return ;
+        }
+        auto packet = NopPacket(true) ;
+        packet.setDelay(latencyEstimator.isValid() ? static_cast<std::int32_t>(latencyEstimator.delay().count()) : -1) ;
+        probeSent = util::ourclock::time_point(std::chrono::duration_cast<util::ourclock::duration>(std::chrono::microseconds(packet.originTime()))) ;
+        probeOutstanding = connection->send(packet) ;
+        wait = std::chrono::seconds(std::max(probeInterval,1)) ;
+    }
+}
+
+// =======================================================================
+auto Client::processProbe(PacketPointer packet) -> void {
+    auto payload = static_cast<NopPacket*>(packet.get()) ;
+    if (payload->respond()) {
+        return ;
+    }
+    auto sent = probeSent ;
+    auto echo = payload->echoTime() ;
+    if (echo != 0) {
+        sent = util::ourclock::time_point(std::chrono::duration_cast<util::ourclock::duration>(std::chrono::microseconds(echo))) ;
+    }
+    else if (!probeOutstanding) {
+        // A server that does not echo, and we have no probe out for this to answer
+        return ;
+    }
+    probeOutstanding = false ;
+    latencyEstimator.addSample(sent, packet->time(), payload->originTime()) ;
+}
+
+// =======================================================================
+auto Client::startStats() -> void {
+    asio::error_code ec ;
+    statsTimer.cancel(ec) ;
+    if (statsInterval <= 0 || reportCallback == nullptr) {
+        return ;
+    }
+    statsTimer.expires_after(std::chrono::seconds(statsInterval)) ;
+    statsTimer.async_wait(std::bind(&Client::statsTick,this,std::placeholders::_1)) ;
+}
+
+// =======================================================================
+auto Client::statsTick(const asio::error_code &ec) -> void {
+    if (ec == asio::error::operation_aborted || connection == nullptr || !connection->is_open()) {
+        return ;
+    }
+    try {
+        reportCallback(this->shared_from_this()) ;
+    }
+    catch(...){}
+    if (statsInterval > 0) {
+        statsTimer.expires_after(std::chrono::seconds(statsInterval)) ;
+        statsTimer.async_wait(std::bind(&Client::statsTick,this,std::placeholders::_1)) ;
+    }
+}
+
 // =======================================================================
 auto Client::processCallback(std::shared_ptr<Packet> packet , ConnectionPointer conn) -> bool {
     auto id = packet->packetID() ;
-    auto iter = std::find_if(packetRoutines.begin(),packetRoutines.end(),[id](const std::pair<PacketType::PacketID, PacketFunction> &entry){
-        return id == entry.first ;
-    });
+    if (forwardCallback != nullptr) {
+        // Pass it on first, so relaying does not wait on our own processing
+        forwardCallback(packet) ;
+    }
+    if (id == PacketType::NOP) {
+        processProbe(packet) ;
+    }
+    auto iter = packetRoutines.find(id) ;
     if (iter != packetRoutines.end()) {
         // We found one!
         return iter->second(this->shared_from_this(),packet);
@@ -39,25 +258,45 @@ auto Client::processCallback(std::shared_ptr<Packet> packet , ConnectionPointer
     return true ;
 }
 
+// =======================================================================
+auto Client::processDatagram(PacketPointer packet) -> bool {
+    // Datagrams are just another source of the same packets, the tcp connection
+    // remains the control channel, so we only act on them while connected
+    if (connection == nullptr || !connection->is_open()) {
+        return true ;
+    }
+    return processCallback(packet, connection) ;
+}
 
 // =======================================================================
-Client::Client(const std::string & name, const PacketRoutines &routines):stopCallback(nullptr),connectBeforeRead(nullptr) {
+Client::Client(const std::string & name, const PacketRoutines &routines, bool own_thread):capabilities(IdentPacket::NONE),probeTimer(client_context),probeInterval(5),probeOutstanding(false),probeRun(0),statsTimer(client_context),statsInterval(0),reportCallback(nullptr),resolver(client_context),retryTimer(client_context),connectTimer(client_context),serverPort(0),bindPort(0),bindFallback(false),useEphemeral(false),active(false),running(false),currentState(ClientState::IDLE),backoff(MINBACKOFF),jitter(std::random_device()()),disconnectTime(std::chrono::steady_clock::now()),reconnectDuration(0),stateCallback(nullptr),stopCallback(nullptr),connectBeforeRead(nullptr),forwardCallback(nullptr) {
     connection = std::make_shared<Connection>(client_context) ;
     connection->setCloseCallback(std::bind(&Client::closeCallback,this,std::placeholders::_1));
     connection->setPacketRoutine(std::bind(&Client::processCallback,this,std::placeholders::_1,std::placeholders::_2));
     connection->handle = name ;
+    syncChannel = std::make_shared<SyncChannel>(client_context) ;
+    syncChannel->setPacketRoutine(std::bind(&Client::processDatagram,this,std::placeholders::_1));
     packetRoutines = routines ;
-    connectThread = std::thread(&Client::runConnection,this) ;
+    if (own_thread) {
+        connectThread = std::thread(&Client::runConnection,this) ;
+    }
 }
 
 // =======================================================================
 Client::~Client() {
+    running = false ;
+    try { probeTimer.cancel(); } catch(...){}
+    try { statsTimer.cancel(); } catch(...){}
+    try { retryTimer.cancel(); } catch(...){}
+    try { connectTimer.cancel(); } catch(...){}
     if (connection->is_open()) {
         // clear out the callbacks
         connection->setCloseCallback(nullptr);
         connection->setPacketRoutine(nullptr);
         connection->close() ;
     }
+    syncChannel->setPacketRoutine(nullptr);
+    syncChannel->close() ;
     if (!client_context.stopped()) {
         client_context.stop() ;
     }
@@ -92,40 +331,6 @@ auto Client::close() -> void {
    
 }
 
-// =======================================================================
-auto Client::connect(const std::string &ip, std::uint16_t port, std::uint16_t bindport) -> bool {
-    
-    // First, can we resolve the server
-    auto endpoint = Connection::resolve(ip, port) ;
-    if (endpoint == asio::ip::tcp::endpoint()) {
-        DBGMSG(std::cerr, "Unable to resolve: "s + ip + " : "s + std::to_string(port)) ;
-        return false ;
-    }
-    if (connection == nullptr) {
-        return false ;
-    }
-    if (!connection->is_open()) {
-        // Why are we here?  we should not be open
-        connection->close() ;
-    }
-    if (!connection->open(bindport) ) {
-        return false ;
-    }
-    if (connection->connect(endpoint) ) {
-        // We connected, what should we do?
-        connection->clearReadTime();
-        connection->clearWriteTime() ;
-
-        auto packet = IdentPacket(connection->handle) ;
-        connection->send(packet) ;
-        if (connectBeforeRead != nullptr){
-            connectBeforeRead(this->shared_from_this());
-        }
-        connection->read() ;
-        return true ;
-    }
-    return false ;
-}
 // =======================================================================
 auto Client::ip() const -> std::string {
     return  connection->peer() ;
@@ -163,7 +368,165 @@ auto Client::setStopCallback(ClientStop function) -> void {
 auto Client::setConnectdBeforeRead(ConnectBeforeRead function) -> void {
     connectBeforeRead = function ;
 }
+
+// =======================================================================
+auto Client::setForwardRoutine(PacketForward function) -> void {
+    forwardCallback = function ;
+}
 // =======================================================================
 auto Client::shutdown()->void {
         connection->shutdown();
 }
+
+// =======================================================================
+auto Client::setSyncPort(std::uint16_t port) -> bool {
+    if (port == 0) {
+        syncChannel->close() ;
+        return true ;
+    }
+    if (syncChannel->is_open() && syncChannel->port() == port) {
+        return true ;
+    }
+    return syncChannel->open(port) ;
+}
+
+// =======================================================================
+auto Client::syncPort() const -> std::uint16_t {
+    return syncChannel->port() ;
+}
+
+// =======================================================================
+auto Client::setProbeInterval(int seconds) -> void {
+    asio::post(client_context,[this,seconds](){
+        auto restart = probeInterval <= 0 && seconds > 0 ;
+        probeInterval = seconds ;
+        if (restart && connection->is_open()) {
+            startProbe() ;
+        }
+    });
+}
+
+// =======================================================================
+auto Client::latency() const -> const LatencyEstimator& {
+    return latencyEstimator ;
+}
+
+// =======================================================================
+auto Client::setCapabilities(std::uint32_t value) -> void {
+    capabilities = value ;
+}
+
+// =======================================================================
+auto Client::context() -> asio::io_context& {
+    return client_context ;
+}
+
+// =======================================================================
+auto Client::run() -> void {
+    if (!connectThread.joinable()) {
+        runConnection() ;
+    }
+}
+
+// =======================================================================
+auto Client::runAt(std::chrono::steady_clock::time_point when, std::function<void()> function) -> void {
+    auto timer = std::make_shared<asio::steady_timer>(client_context, when) ;
+    // The handler holds the timer until it fires
+    timer->async_wait([timer,function](const asio::error_code &ec){
+        if (!ec && function != nullptr) {
+            try {
+                function() ;
+            }
+            catch(...){}
+        }
+    });
+}
+
+// =======================================================================
+auto Client::setStatsInterval(int seconds) -> void {
+    asio::post(client_context,[this,seconds](){
+        auto changed = seconds != statsInterval ;
+        statsInterval = seconds ;
+        if (changed && connection->is_open()) {
+            startStats() ;
+        }
+    });
+}
+
+// =======================================================================
+auto Client::setReportCallback(ClientReport function) -> void {
+    asio::post(client_context,[this,function](){
+        reportCallback = function ;
+    });
+}
+
+// =======================================================================
+auto Client::start(const std::string &ip, std::uint16_t port, std::uint16_t bindport, bool bindfallback) -> void {
+    // Set before we post, so isRunning() reflects this right away and the resolve
+    // we post does not see us as stopped
+    running = true ;
+    asio::post(client_context,[this,ip,port,bindport,bindfallback](){
+        auto retarget = ip != serverName || port != serverPort || bindport != bindPort ;
+        bindFallback = bindfallback ;
+        if (active && !retarget) {
+            return ;
+        }
+        serverName = ip ;
+        serverPort = port ;
+        bindPort = bindport ;
+        cachedEndpoint = asio::ip::tcp::endpoint() ;
+        backoff = MINBACKOFF ;
+        useEphemeral = false ;
+        if (!active) {
+            active = true ;
+            disconnectTime = std::chrono::steady_clock::now() ;
+        }
+        if (connection->is_open()) {
+            // Closing it, gets us back to connecting to the new server
+            connection->shutdown() ;
+            connection->close() ;
+            return ;
+        }
+        asio::error_code ec ;
+        retryTimer.cancel(ec) ;
+        beginResolve() ;
+    });
+}
+
+// =======================================================================
+auto Client::stop() -> void {
+    running = false ;
+    asio::post(client_context,[this](){
+        active = false ;
+        asio::error_code ec ;
+        resolver.cancel() ;
+        retryTimer.cancel(ec) ;
+        connectTimer.cancel(ec) ;
+        probeTimer.cancel(ec) ;
+        if (connection->is_open()) {
+            connection->shutdown() ;
+            connection->close() ;
+        }
+        setState(ClientState::IDLE) ;
+    });
+}
+
+// =======================================================================
+auto Client::isRunning() const -> bool {
+    return running ;
+}
+
+// =======================================================================
+auto Client::state() const -> ClientState {
+    return currentState ;
+}
+
+// =======================================================================
+auto Client::reconnectTime() const -> std::int64_t {
+    return reconnectDuration ;
+}
+
+// =======================================================================
+auto Client::setStateCallback(ClientStateChange function) -> void {
+    stateCallback = function ;
+}
@@ -8,19 +8,31 @@
 #include <memory>
 #include <functional>
 #include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <random>
 
 #include "network/Connection.hpp"
+#include "network/SyncChannel.hpp"
+#include "network/LatencyEstimator.hpp"
 #include "packets/Packet.hpp"
 
 #include "asio.hpp"
 
 class Client ;
 
+enum class ClientState {
+    IDLE,RESOLVING,CONNECTING,CONNECTED,WAITING
+};
+
 using ClientPointer = std::shared_ptr<Client> ;
 using ClientStop = std::function<void(ClientPointer)>;
 using PacketFunction = std::function<bool(ClientPointer,PacketPointer)> ;
 using PacketRoutines = std::unordered_map<PacketType::PacketID, PacketFunction> ;
 using ConnectBeforeRead = std::function<void(ClientPointer)> ;
+using ClientStateChange = std::function<void(ClientPointer,ClientState)> ;
+using ClientReport = std::function<void(ClientPointer)> ;
+using PacketForward = std::function<void(PacketPointer)> ;
 class Client : public std::enable_shared_from_this<Client> {
     friend class Connection ;
     
@@ -28,24 +40,86 @@ class Client : public std::enable_shared_from_this<Client> {
     asio::executor_work_guard<asio::io_context::executor_type> clientguard{asio::make_work_guard(client_context)} ;
     
     ConnectionPointer connection ;
+    SyncChannelPointer syncChannel ;
+    std::atomic<std::uint32_t> capabilities ;
+    
+    // Round trip probes, for our delay estimate to the server
+    asio::steady_timer probeTimer ;
+    int probeInterval ;
+    bool probeOutstanding ;
+    util::ourclock::time_point probeSent ;
+    // Each start bumps this, so a loop from an earlier connection knows to finish
+    std::uint64_t probeRun ;
+    LatencyEstimator latencyEstimator ;
+    auto startProbe() -> void ;
+    auto probeLoop(std::uint64_t run) -> asio::awaitable<void> ;
+    auto processProbe(PacketPointer packet) -> void ;
+    
+    // Periodic telemetry, the report callback builds and sends it
+    asio::steady_timer statsTimer ;
+    int statsInterval ;
+    ClientReport reportCallback ;
+    auto startStats() -> void ;
+    auto statsTick(const asio::error_code &ec) -> void ;
     
     std::thread connectThread ;
     auto runConnection() -> void ;
+    
+    // The connection state machine, all run on client_context
+    static constexpr auto MINBACKOFF = std::chrono::milliseconds(250) ;
+    static constexpr auto MAXBACKOFF = std::chrono::milliseconds(8000) ;
+    static constexpr auto CONNECTTIMEOUT = std::chrono::seconds(5) ;
+    asio::ip::tcp::resolver resolver ;
+    asio::steady_timer retryTimer ;
+    asio::steady_timer connectTimer ;
+    std::string serverName ;
+    std::uint16_t serverPort ;
+    std::uint16_t bindPort ;
+    bool bindFallback ;
+    bool useEphemeral ;
+    asio::ip::tcp::endpoint cachedEndpoint ;
+    bool active ;   // the state machine has been started (only used on client_context)
+    std::atomic<bool> running ;
+    std::atomic<ClientState> currentState ;
+    std::chrono::milliseconds backoff ;
+    std::minstd_rand jitter ;
+    std::chrono::steady_clock::time_point disconnectTime ;
+    std::atomic<std::int64_t> reconnectDuration ;
+    ClientStateChange stateCallback ;
+    auto setState(ClientState state) -> void ;
+    auto beginResolve() -> void ;
+    auto resolveHandler(const asio::error_code &ec, asio::ip::tcp::resolver::results_type results) -> void ;
+    auto beginConnect() -> void ;
+    auto connectHandler(const asio::error_code &ec) -> void ;
+    auto scheduleRetry() -> void ;
+    auto connected() -> void ;
+
     PacketRoutines packetRoutines ;
     ClientStop stopCallback ;
     ConnectBeforeRead connectBeforeRead;
+    PacketForward forwardCallback ;
     auto closeCallback(ConnectionPointer conn) -> void ;
     auto processCallback(PacketPointer packet , ConnectionPointer conn) -> bool ;
+    auto processDatagram(PacketPointer packet) -> bool ;
     
 public:
-    Client(const std::string &name, const PacketRoutines &routines ) ;
+    // Without its own thread, the context only runs in run()
+    Client(const std::string &name, const PacketRoutines &routines, bool own_thread = true ) ;
     ~Client() ;
     
     auto send(const Packet &packet) -> bool ;
     auto is_open() const -> bool ;
     auto close() -> void ;
 
-    auto connect(const std::string &ip, std::uint16_t port, std::uint16_t bindport) -> bool ;
+    // Starts (or retargets) the connection state machine, it keeps the client connected until stopped.
+    // If bindfallback is set, we use an ephemeral port when the bind port is unusable (TIME_WAIT)
+    auto start(const std::string &ip, std::uint16_t port, std::uint16_t bindport, bool bindfallback = false) -> void ;
+    auto stop() -> void ;
+    auto isRunning() const -> bool ;
+    auto state() const -> ClientState ;
+    // How long (milliseconds) it took to connect after the last disconnect (or start)
+    auto reconnectTime() const -> std::int64_t ;
+    auto setStateCallback(ClientStateChange function) -> void ;
     auto ip() const -> std::string ;
     auto timeStamp() -> util::ourclock::time_point ;
     auto handle() const -> const std::string& ;
@@ -54,6 +128,29 @@ public:
     auto clearWriteTime() -> void ;
     auto setStopCallback(ClientStop function) -> void ;
     auto setConnectdBeforeRead(ConnectBeforeRead function) -> void ;
+    // Sees every packet from the server (tcp or datagram) before it is processed, for relaying
+    auto setForwardRoutine(PacketForward function) -> void ;
     auto shutdown() ->void ;
+    // The context the client runs on, for work that should share its thread
+    auto context() -> asio::io_context& ;
+    // Runs the context on this thread (a client without its own), until it is stopped
+    auto run() -> void ;
+    // Run something on the client's context at a given time
+    auto runAt(std::chrono::steady_clock::time_point when, std::function<void()> function) -> void ;
+    
+    // The optional udp channel for SYNC/BUFFER datagrams (0 closes it)
+    auto setSyncPort(std::uint16_t port) -> bool ;
+    auto syncPort() const -> std::uint16_t ;
+    
+    // The IdentPacket::Capability mask sent with our ident, used from the next connect
+    auto setCapabilities(std::uint32_t value) -> void ;
+    
+    // How often (seconds) we send a timestamped nop to measure the round trip (0 disables)
+    auto setProbeInterval(int seconds) -> void ;
+    auto latency() const -> const LatencyEstimator& ;
+    
+    // How often (seconds) the report callback is called while connected (0 disables)
+    auto setStatsInterval(int seconds) -> void ;
+    auto setReportCallback(ClientReport function) -> void ;
 };
 #endif /* Client_hpp */
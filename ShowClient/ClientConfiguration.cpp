@@ -8,8 +8,16 @@ using namespace std::string_literals ;
 // ==============================================================================================
 ClientConfiguration::ClientConfiguration(): BaseConfiguration() {
     clientPort = 50001 ;
+    bindFallback = false ;
     serverIP = "windsorway.org" ;
     serverPort = 50000 ;
+    syncPort = 0 ;
+    probeInterval = 5 ;
+    statsInterval = 30 ;
+    useCompression = true ;
+    sceneCache = 1024 ;
+    relayPort = 0 ;
+    relayQueue = 1024 ;
     
     name = "Blinky Show Client" ;
     
@@ -21,6 +29,9 @@ ClientConfiguration::ClientConfiguration(): BaseConfiguration() {
     
     useAudio = false ;
     useLight = false ;
+    audioClock = false ;
+    timerSpin = 1000 ;
+    sharedThread = false ;
     
     audioDevice = 0 ;
  
@@ -33,6 +44,13 @@ ClientConfiguration::ClientConfiguration(const std::filesystem::path &path): Cli
     }
 }
 
+// ===============================================================================================
+// universe lines accumulate, so a reload starts them over
+auto ClientConfiguration::beginLoad() -> void {
+    universes.clear() ;
+    inputs.clear() ;
+}
+
 // ===============================================================================================
 auto ClientConfiguration::processKeyValue(const std::string &key, const std::string &value) ->void {
     auto ukey = util::upper(key) ;
@@ -40,6 +58,9 @@ auto ClientConfiguration::processKeyValue(const std::string &key, const std::str
         if (ukey == "CLIENTPORT") {
             clientPort = static_cast<std::uint16_t>(std::stoul(value,nullptr,0));
         }
+        else if (ukey == "BINDFALLBACK") {
+            bindFallback = std::stoi(value,nullptr,0) != 0 ;
+        }
         else if (ukey == "SERVER") {
             // we need to spit it up
             auto [ip,port] = util::split(value,",") ;
@@ -49,6 +70,27 @@ auto ClientConfiguration::processKeyValue(const std::string &key, const std::str
             serverPort = static_cast<std::uint16_t>(std::stoul(port,nullptr,0));
             serverIP = ip ;
         }
+        else if (ukey == "SYNCPORT") {
+            syncPort = static_cast<std::uint16_t>(std::stoul(value,nullptr,0));
+        }
+        else if (ukey == "PROBEINTERVAL") {
+            probeInterval = std::stoi(value,nullptr,0) ;
+        }
+        else if (ukey == "STATSINTERVAL") {
+            statsInterval = std::stoi(value,nullptr,0) ;
+        }
+        else if (ukey == "COMPRESSION") {
+            useCompression = std::stoi(value,nullptr,0) != 0 ;
+        }
+        else if (ukey == "SCENECACHE") {
+            sceneCache = std::stoi(value,nullptr,0) ;
+        }
+        else if (ukey == "RELAYPORT") {
+            relayPort = static_cast<std::uint16_t>(std::stoul(value,nullptr,0)) ;
+        }
+        else if (ukey == "RELAYQUEUE") {
+            relayQueue = std::stoi(value,nullptr,0) ;
+        }
         else if (ukey == "NAME") {
             name = value ;
         }
@@ -79,12 +121,30 @@ auto ClientConfiguration::processKeyValue(const std::string &key, const std::str
         else if (ukey == "LIGHTS") {
             useLight = std::stoi(value,nullptr,0) != 0 ;
         }
+        else if (ukey == "AUDIOCLOCK") {
+            audioClock = std::stoi(value,nullptr,0) != 0 ;
+        }
+        else if (ukey == "SYNCLOOP") {
+            syncTuning = SyncDiscipline::Tuning(value) ;
+        }
+        else if (ukey == "TIMERSPIN") {
+            timerSpin = std::stoi(value,nullptr,0) ;
+        }
+        else if (ukey == "THREADING") {
+            sharedThread = util::upper(value) == "SHARED" ;
+        }
         else if (ukey == "PRU") {
             auto pru = PRUConfig(value)  ;
             if (pru.pru == PruNumber::zero || pru.pru == PruNumber::one) {
                 pruSetting.at(static_cast<int>(pru.pru)) = pru ;
             }
         }
+        else if (ukey == "UNIVERSE") {
+            universes.push_back(UniverseConfig(value)) ;
+        }
+        else if (ukey == "INPUT") {
+            inputs.push_back(UniverseConfig(value)) ;
+        }
     }
     catch(...) {
         throw std::runtime_error("Errors processing client configuration");
@@ -5,13 +5,17 @@
 
 #include <cstdint>
 #include <array>
+#include <vector>
 
 #include "utility/BaseConfiguration.hpp"
 #include "utility/timeutil.hpp"
 
 #include "PRUConfig.hpp"
+#include "SyncDiscipline.hpp"
+#include "UniverseConfig.hpp"
 
 class ClientConfiguration: public BaseConfiguration {
+    auto beginLoad() -> void final ;
     auto processKeyValue(const std::string &key, const std::string &value) ->void final ;
     
 public:
@@ -20,12 +24,22 @@ public:
     
     
     std::uint16_t clientPort ;
+    bool bindFallback ;
     std::string serverIP ;
     std::uint16_t serverPort ;
+    std::uint16_t syncPort ;
+    int probeInterval ;
+    int statsInterval ;
+    bool useCompression ;
+    int sceneCache ;
+    std::uint16_t relayPort ;
+    int relayQueue ;
     
     std::string name ;
     
     std::array<PRUConfig,2> pruSetting ;
+    std::vector<UniverseConfig> universes ;
+    std::vector<UniverseConfig> inputs ;
     
     std::filesystem::path musicPath ;
     std::filesystem::path lightPath ;
@@ -37,6 +51,12 @@ public:
     
     bool useAudio ;
     bool useLight ;
+    bool audioClock ;
+    SyncDiscipline::Tuning syncTuning ;
+    int timerSpin ;     // microseconds
+    // Network, config and status all on the main thread, beside one real time
+    // light output thread (read once, at start)
+    bool sharedThread ;
     
     int audioDevice ;
  
@@ -0,0 +1,266 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "ClientStatistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "utility/timeutil.hpp"
+
+using namespace std::string_literals ;
+
+//======================================================================
+ClientStatistics::ClientStatistics() : latenessMax(0),ticks(0),dropped(0),underruns(0),syncCount(0),syncTotal(0),syncMax(0),loads(0),loadMax(0),decodes(0),decodeEncoded(0),decodeDecoded(0),decodeTime(0),decodeMax(0),sceneHits(0),sceneMisses(0),startSkew(0),gapCount(0),gapTotal(0),gapMax(0),bridgeFrames(0),bridgeStamped(0),bridgeTotal(0),bridgeMax(0),bridgeLost(0),avDrift(0),avDriftMax(0),lastReport(std::chrono::steady_clock::now()),lastCpu(cpuTime()) {
+    for (auto &entry : lateness) {
+        entry = 0 ;
+    }
+    for (auto &entry : landing) {
+        entry = 0 ;
+    }
+    for (auto &entry : syncOffset) {
+        entry = 0 ;
+    }
+    for (auto &entry : clockDrift) {
+        entry = 0 ;
+    }
+}
+
+//======================================================================
+auto ClientStatistics::instance() -> ClientStatistics& {
+    static ClientStatistics statistics ;
+    return statistics ;
+}
+
+//======================================================================
+auto ClientStatistics::updateMax(std::atomic<std::uint32_t> &target, std::uint32_t value) -> void {
+    auto current = target.load(std::memory_order_relaxed) ;
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+//======================================================================
+// Process cpu time (user + system) in microseconds
+auto ClientStatistics::cpuTime() -> std::int64_t {
+#if !defined(_WIN32)
+    auto usage = rusage() ;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return (static_cast<std::int64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000) + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec ;
+    }
+#endif
+    return 0 ;
+}
+
+//======================================================================
+// Resident set size in KB, 0 where /proc is not available
+auto ClientStatistics::residentSize() -> std::uint32_t {
+#if !defined(_WIN32)
+    auto input = std::ifstream("/proc/self/statm") ;
+    auto size = std::uint64_t(0) ;
+    auto resident = std::uint64_t(0) ;
+    if (input.is_open() && (input >> size >> resident)) {
+        return static_cast<std::uint32_t>((resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE))) / 1024) ;
+    }
+#endif
+    return 0 ;
+}
+
+//======================================================================
+auto ClientStatistics::percentile(const std::array<std::uint32_t,BUCKETCOUNT> &counts, std::uint32_t total, int percent, std::uint32_t maximum) const -> std::uint32_t {
+    if (total == 0) {
+        return 0 ;
+    }
+    auto rank = (static_cast<std::uint64_t>(total) * percent + 99) / 100 ;
+    auto seen = std::uint64_t(0) ;
+    for (auto index = 0 ; index < BUCKETCOUNT - 1 ; index++) {
+        seen += counts[index] ;
+        if (seen >= rank) {
+            // Report the top of the bucket, but never more than we actually saw
+            return std::min(static_cast<std::uint32_t>((index + 1) * BUCKETWIDTH), maximum) ;
+        }
+    }
+    return maximum ;
+}
+
+//======================================================================
+auto ClientStatistics::recordTick(std::chrono::microseconds late, std::chrono::microseconds period) -> void {
+    auto value = static_cast<std::uint32_t>(std::max(late.count(), std::int64_t(0))) ;
+    auto bucket = std::min(static_cast<int>(value / BUCKETWIDTH), BUCKETCOUNT - 1) ;
+    lateness[bucket].fetch_add(1, std::memory_order_relaxed) ;
+    ticks.fetch_add(1, std::memory_order_relaxed) ;
+    updateMax(latenessMax, value) ;
+    if (period.count() > 0 && late >= period) {
+        dropped.fetch_add(1, std::memory_order_relaxed) ;
+    }
+}
+
+//======================================================================
+auto ClientStatistics::recordUnderrun() -> void {
+    underruns.fetch_add(1, std::memory_order_relaxed) ;
+}
+
+//======================================================================
+auto ClientStatistics::recordSync(int delta) -> void {
+    auto magnitude = static_cast<std::uint32_t>(std::abs(delta)) ;
+    syncCount.fetch_add(1, std::memory_order_relaxed) ;
+    syncTotal.fetch_add(magnitude, std::memory_order_relaxed) ;
+    updateMax(syncMax, magnitude) ;
+}
+
+//======================================================================
+auto ClientStatistics::recordLoad(std::chrono::milliseconds duration) -> void {
+    loads.fetch_add(1, std::memory_order_relaxed) ;
+    updateMax(loadMax, static_cast<std::uint32_t>(std::max(duration.count(), static_cast<std::chrono::milliseconds::rep>(0)))) ;
+}
+
+//======================================================================
+auto ClientStatistics::recordDecode(std::uint32_t encoded, std::uint32_t decoded, std::chrono::microseconds duration) -> void {
+    auto micro = static_cast<std::uint32_t>(std::max(duration.count(), static_cast<std::chrono::microseconds::rep>(0))) ;
+    decodes.fetch_add(1, std::memory_order_relaxed) ;
+    decodeEncoded.fetch_add(encoded, std::memory_order_relaxed) ;
+    decodeDecoded.fetch_add(decoded, std::memory_order_relaxed) ;
+    decodeTime.fetch_add(micro, std::memory_order_relaxed) ;
+    updateMax(decodeMax, micro) ;
+}
+
+//======================================================================
+auto ClientStatistics::recordScene(bool hit) -> void {
+    if (hit) {
+        sceneHits.fetch_add(1, std::memory_order_relaxed) ;
+    }
+    else {
+        sceneMisses.fetch_add(1, std::memory_order_relaxed) ;
+    }
+}
+
+//======================================================================
+auto ClientStatistics::recordLanding(Output output, std::chrono::microseconds error) -> void {
+    auto value = std::clamp<std::int64_t>(error.count(), std::numeric_limits<std::int32_t>::min(), std::numeric_limits<std::int32_t>::max()) ;
+    landing[output].store(static_cast<std::int32_t>(value), std::memory_order_relaxed) ;
+}
+
+//======================================================================
+auto ClientStatistics::recordStartSkew(std::chrono::microseconds skew) -> void {
+    auto value = std::clamp<std::int64_t>(skew.count(), std::numeric_limits<std::int32_t>::min(), std::numeric_limits<std::int32_t>::max()) ;
+    startSkew.store(static_cast<std::int32_t>(value), std::memory_order_relaxed) ;
+}
+
+//======================================================================
+auto ClientStatistics::recordReceiveGap(std::chrono::microseconds gap) -> void {
+    auto micro = static_cast<std::uint32_t>(std::clamp<std::int64_t>(gap.count(), 0, std::numeric_limits<std::uint32_t>::max())) ;
+    gapCount.fetch_add(1, std::memory_order_relaxed) ;
+    gapTotal.fetch_add(micro, std::memory_order_relaxed) ;
+    updateMax(gapMax, micro) ;
+}
+
+//======================================================================
+auto ClientStatistics::recordBridgeFrame(std::chrono::microseconds latency) -> void {
+    bridgeFrames.fetch_add(1, std::memory_order_relaxed) ;
+    if (latency.count() < 0) {
+        return ;
+    }
+    auto micro = static_cast<std::uint32_t>(std::min<std::int64_t>(latency.count(), std::numeric_limits<std::uint32_t>::max())) ;
+    bridgeStamped.fetch_add(1, std::memory_order_relaxed) ;
+    bridgeTotal.fetch_add(micro, std::memory_order_relaxed) ;
+    updateMax(bridgeMax, micro) ;
+}
+
+//======================================================================
+auto ClientStatistics::recordBridgeLoss(std::uint32_t count) -> void {
+    bridgeLost.fetch_add(count, std::memory_order_relaxed) ;
+}
+
+//======================================================================
+auto ClientStatistics::recordDrift(std::chrono::microseconds drift) -> void {
+    auto value = std::clamp<std::int64_t>(drift.count(), std::numeric_limits<std::int32_t>::min() + 1, std::numeric_limits<std::int32_t>::max()) ;
+    avDrift.store(static_cast<std::int32_t>(value), std::memory_order_relaxed) ;
+    updateMax(avDriftMax, static_cast<std::uint32_t>(std::abs(value))) ;
+}
+
+//======================================================================
+auto ClientStatistics::recordDiscipline(Output output, std::chrono::microseconds offset, double drift) -> void {
+    auto value = std::clamp<std::int64_t>(offset.count(), std::numeric_limits<std::int32_t>::min(), std::numeric_limits<std::int32_t>::max()) ;
+    syncOffset[output].store(static_cast<std::int32_t>(value), std::memory_order_relaxed) ;
+    clockDrift[output].store(static_cast<std::int32_t>(std::lround(drift * 1000000.0)), std::memory_order_relaxed) ;
+}
+
+//======================================================================
+auto ClientStatistics::reset() -> void {
+    report(0) ;
+}
+
+//======================================================================
+auto ClientStatistics::report(std::int32_t delay) -> StatsPacket {
+    auto packet = StatsPacket() ;
+    auto now = std::chrono::steady_clock::now() ;
+    auto interval = std::chrono::duration_cast<std::chrono::microseconds>(now - lastReport).count() ;
+    auto cpu = cpuTime() ;
+    
+    auto counts = std::array<std::uint32_t,BUCKETCOUNT>() ;
+    auto total = std::uint32_t(0) ;
+    for (auto index = 0 ; index < BUCKETCOUNT ; index++) {
+        counts[index] = lateness[index].exchange(0, std::memory_order_relaxed) ;
+        total += counts[index] ;
+    }
+    auto maximum = latenessMax.exchange(0, std::memory_order_relaxed) ;
+    
+    packet.setValue(StatsPacket::INTERVAL, static_cast<std::uint32_t>(interval / 1000)) ;
+    packet.setValue(StatsPacket::TICKS, ticks.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::LATENESS50, percentile(counts, total, 50, maximum)) ;
+    packet.setValue(StatsPacket::LATENESS95, percentile(counts, total, 95, maximum)) ;
+    packet.setValue(StatsPacket::LATENESS99, percentile(counts, total, 99, maximum)) ;
+    packet.setValue(StatsPacket::LATENESSMAX, maximum) ;
+    packet.setValue(StatsPacket::DROPPED, dropped.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::UNDERRUNS, underruns.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::SYNCCOUNT, syncCount.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::SYNCTOTAL, syncTotal.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::SYNCMAX, syncMax.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::LOADS, loads.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::LOADMAX, loadMax.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::RSS, residentSize()) ;
+    packet.setValue(StatsPacket::CPU, interval > 0 ? static_cast<std::uint32_t>(((cpu - lastCpu) * 1000) / interval) : 0) ;
+    packet.setValue(StatsPacket::DELAY, static_cast<std::uint32_t>(delay)) ;
+    auto count = decodes.exchange(0, std::memory_order_relaxed) ;
+    auto encoded = decodeEncoded.exchange(0, std::memory_order_relaxed) ;
+    auto decoded = decodeDecoded.exchange(0, std::memory_order_relaxed) ;
+    auto time = decodeTime.exchange(0, std::memory_order_relaxed) ;
+    packet.setValue(StatsPacket::ZBUFFERS, count) ;
+    packet.setValue(StatsPacket::ZRATIO, encoded > 0 ? static_cast<std::uint32_t>((decoded * 100) / encoded) : 0) ;
+    packet.setValue(StatsPacket::ZDECODEAVG, count > 0 ? static_cast<std::uint32_t>(time / count) : 0) ;
+    packet.setValue(StatsPacket::ZDECODEMAX, decodeMax.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::SCENEHITS, sceneHits.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::SCENEMISSES, sceneMisses.exchange(0, std::memory_order_relaxed)) ;
+    auto gaps = gapCount.exchange(0, std::memory_order_relaxed) ;
+    auto gapTime = gapTotal.exchange(0, std::memory_order_relaxed) ;
+    packet.setValue(StatsPacket::RXGAPAVG, gaps > 0 ? static_cast<std::uint32_t>(gapTime / gaps) : 0) ;
+    packet.setValue(StatsPacket::RXGAPMAX, gapMax.exchange(0, std::memory_order_relaxed)) ;
+    auto stamped = bridgeStamped.exchange(0, std::memory_order_relaxed) ;
+    auto bridgeTime = bridgeTotal.exchange(0, std::memory_order_relaxed) ;
+    packet.setValue(StatsPacket::BRIDGEFRAMES, bridgeFrames.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::BRIDGELATAVG, stamped > 0 ? static_cast<std::uint32_t>(bridgeTime / stamped) : 0) ;
+    packet.setValue(StatsPacket::BRIDGELATMAX, bridgeMax.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::BRIDGELOST, bridgeLost.exchange(0, std::memory_order_relaxed)) ;
+    packet.setValue(StatsPacket::AVDRIFT, static_cast<std::uint32_t>(avDrift.exchange(0, std::memory_order_relaxed))) ;
+    packet.setValue(StatsPacket::AVDRIFTMAX, avDriftMax.exchange(0, std::memory_order_relaxed)) ;
+    // These stay with the last start, they are not per interval
+    packet.setValue(StatsPacket::LIGHTLANDING, static_cast<std::uint32_t>(landing[LIGHT].load(std::memory_order_relaxed))) ;
+    packet.setValue(StatsPacket::AUDIOLANDING, static_cast<std::uint32_t>(landing[AUDIO].load(std::memory_order_relaxed))) ;
+    auto clock = util::clockError() ;
+    packet.setValue(StatsPacket::LIGHTOFFSET, static_cast<std::uint32_t>(syncOffset[LIGHT].load(std::memory_order_relaxed))) ;
+    packet.setValue(StatsPacket::AUDIOOFFSET, static_cast<std::uint32_t>(syncOffset[AUDIO].load(std::memory_order_relaxed))) ;
+    packet.setValue(StatsPacket::LIGHTDRIFT, static_cast<std::uint32_t>(clockDrift[LIGHT].load(std::memory_order_relaxed))) ;
+    packet.setValue(StatsPacket::AUDIODRIFT, static_cast<std::uint32_t>(clockDrift[AUDIO].load(std::memory_order_relaxed))) ;
+    packet.setValue(StatsPacket::STARTSKEW, static_cast<std::uint32_t>(startSkew.load(std::memory_order_relaxed))) ;
+    packet.setValue(StatsPacket::CLOCKERROR, static_cast<std::uint32_t>(static_cast<std::int32_t>(std::min<std::int64_t>(clock, std::numeric_limits<std::int32_t>::max())))) ;
+    
+    lastReport = now ;
+    lastCpu = cpu ;
+    return packet ;
+}
@@ -0,0 +1,107 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef ClientStatistics_hpp
+#define ClientStatistics_hpp
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "packets/StatsPacket.hpp"
+
+//======================================================================
+// Counters the playback paths bump as they run. Every record call is a
+// relaxed atomic update so it is safe from the light timer thread and the
+// audio callback; report() swaps the counters out and starts a new interval.
+class ClientStatistics {
+public:
+    enum Output {
+        LIGHT = 0, AUDIO
+    };
+    // Tick lateness is bucketed in 250us steps up to 16ms, with one
+    // overflow bucket past that
+    static constexpr auto BUCKETWIDTH = 250 ;
+    static constexpr auto BUCKETCOUNT = 65 ;
+    
+private:
+    std::array<std::atomic<std::uint32_t>,BUCKETCOUNT> lateness ;
+    std::atomic<std::uint32_t> latenessMax ;
+    std::atomic<std::uint32_t> ticks ;
+    std::atomic<std::uint32_t> dropped ;
+    std::atomic<std::uint32_t> underruns ;
+    std::atomic<std::uint32_t> syncCount ;
+    std::atomic<std::uint32_t> syncTotal ;
+    std::atomic<std::uint32_t> syncMax ;
+    std::atomic<std::uint32_t> loads ;
+    std::atomic<std::uint32_t> loadMax ;
+    std::atomic<std::uint32_t> decodes ;
+    std::atomic<std::uint64_t> decodeEncoded ;
+    std::atomic<std::uint64_t> decodeDecoded ;
+    std::atomic<std::uint64_t> decodeTime ;
+    std::atomic<std::uint32_t> decodeMax ;
+    std::atomic<std::uint32_t> sceneHits ;
+    std::atomic<std::uint32_t> sceneMisses ;
+    std::array<std::atomic<std::int32_t>,2> landing ;
+    std::atomic<std::int32_t> startSkew ;
+    std::atomic<std::uint32_t> gapCount ;
+    std::atomic<std::uint64_t> gapTotal ;
+    std::atomic<std::uint32_t> gapMax ;
+    std::atomic<std::uint32_t> bridgeFrames ;
+    std::atomic<std::uint32_t> bridgeStamped ;
+    std::atomic<std::uint64_t> bridgeTotal ;
+    std::atomic<std::uint32_t> bridgeMax ;
+    std::atomic<std::uint32_t> bridgeLost ;
+    std::atomic<std::int32_t> avDrift ;
+    std::atomic<std::uint32_t> avDriftMax ;
+    std::array<std::atomic<std::int32_t>,2> syncOffset ;
+    std::array<std::atomic<std::int32_t>,2> clockDrift ;
+    
+    // Only touched by report()
+    std::chrono::steady_clock::time_point lastReport ;
+    std::int64_t lastCpu ;
+    
+    static auto updateMax(std::atomic<std::uint32_t> &target, std::uint32_t value) -> void ;
+    static auto cpuTime() -> std::int64_t ;
+    static auto residentSize() -> std::uint32_t ;
+    auto percentile(const std::array<std::uint32_t,BUCKETCOUNT> &counts, std::uint32_t total, int percent, std::uint32_t maximum) const -> std::uint32_t ;
+    
+    ClientStatistics() ;
+public:
+    static auto instance() -> ClientStatistics& ;
+    ClientStatistics(const ClientStatistics&) = delete ;
+    auto operator=(const ClientStatistics&) -> ClientStatistics& = delete ;
+    
+    // How far past its deadline a light tick ran; a tick a whole period late
+    // also counts as a dropped frame
+    auto recordTick(std::chrono::microseconds late, std::chrono::microseconds period) -> void ;
+    auto recordUnderrun() -> void ;
+    // A frame adjustment made to follow the server sync
+    auto recordSync(int delta) -> void ;
+    auto recordLoad(std::chrono::milliseconds duration) -> void ;
+    // A compressed buffer, its sizes and how long it took to decode
+    auto recordDecode(std::uint32_t encoded, std::uint32_t decoded, std::chrono::microseconds duration) -> void ;
+    auto recordScene(bool hit) -> void ;
+    // How far from its target the first output of a start went out (positive is late)
+    auto recordLanding(Output output, std::chrono::microseconds error) -> void ;
+    auto recordStartSkew(std::chrono::microseconds skew) -> void ;
+    // How long after the kernel received a SYNC we got to it
+    auto recordReceiveGap(std::chrono::microseconds gap) -> void ;
+    // A frame the E1.31 bridge wrote, and how long after the kernel received it (negative if unknown)
+    auto recordBridgeFrame(std::chrono::microseconds latency) -> void ;
+    // E1.31 packets missing from a universe's sequence
+    auto recordBridgeLoss(std::uint32_t count) -> void ;
+    // How far the audio playback is from the light timer (positive is the audio ahead)
+    auto recordDrift(std::chrono::microseconds drift) -> void ;
+    // Where an output's sync loop is: its offset from the server, and the drift (fraction fast) it estimates
+    auto recordDiscipline(Output output, std::chrono::microseconds offset, double drift) -> void ;
+    
+    // Start a new interval, dropping anything counted so far
+    auto reset() -> void ;
+    // Fill a packet with the interval since the last report and reset
+    auto report(std::int32_t delay) -> StatsPacket ;
+};
+
+#endif /* ClientStatistics_hpp */
@@ -0,0 +1,140 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "ConfigWatcher.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "utility/dbgutil.hpp"
+
+using namespace std::string_literals ;
+
+//======================================================================
+ConfigWatcher::ConfigWatcher():context(nullptr),changedRoutine(nullptr),watching(false),inotify(-1) {
+}
+
+//======================================================================
+auto ConfigWatcher::start(asio::io_context &io_context, const std::filesystem::path &path, Changed routine) -> bool {
+#if defined(__linux__)
+    context = &io_context ;
+    changedRoutine = routine ;
+    // Through any link, to the directory the file really is in
+    auto ec = std::error_code() ;
+    auto target = std::filesystem::weakly_canonical(path, ec) ;
+    if (ec) {
+        target = std::filesystem::absolute(path, ec) ;
+    }
+    fileName = target.filename().string() ;
+    inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC) ;
+    if (inotify < 0) {
+        DBGMSG(std::cerr, "Unable to watch the configuration file: "s + std::strerror(errno));
+        return false ;
+    }
+    if (::inotify_add_watch(inotify, target.parent_path().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        DBGMSG(std::cerr, "Unable to watch "s + target.parent_path().string() + ": "s + std::strerror(errno));
+        ::close(inotify) ;
+        inotify = -1 ;
+        return false ;
+    }
+    watching = true ;
+    asio::post(io_context,[this](){
+        if (inotify < 0) {
+            return ;
+        }
+        descriptor = std::make_unique<asio::posix::stream_descriptor>(*context, inotify) ;
+        settle = std::make_unique<asio::steady_timer>(*context) ;
+        this->waitEvents() ;
+    });
+    return true ;
+#else
+    return false ;
+#endif
+}
+
+//======================================================================
+auto ConfigWatcher::waitEvents() -> void {
+#if defined(__linux__)
+    descriptor->async_wait(asio::posix::stream_descriptor::wait_read,[this](const asio::error_code &ec){
+        if (ec || descriptor == nullptr) {
+            if (ec && ec != asio::error::operation_aborted) {
+                DBGMSG(std::cerr, "Configuration file is no longer watched, polling it: "s + ec.message());
+                watching = false ;
+            }
+            return ;
+        }
+        if (this->readEvents()) {
+            // A new event restarts the wait, the routine sees the save once it is done
+            settle->expires_after(SETTLE) ;
+            settle->async_wait([this](const asio::error_code &ec){
+                if (!ec && changedRoutine != nullptr) {
+                    changedRoutine() ;
+                }
+            });
+        }
+        if (watching) {
+            this->waitEvents() ;
+        }
+    });
+#endif
+}
+
+//======================================================================
+auto ConfigWatcher::readEvents() -> bool {
+    auto ours = false ;
+#if defined(__linux__)
+    alignas(inotify_event) auto buffer = std::array<char,4096>() ;
+    while (true) {
+        auto amount = ::read(inotify, buffer.data(), buffer.size()) ;
+        if (amount <= 0) {
+            break ;
+        }
+        auto offset = std::size_t(0) ;
+        while (offset + sizeof(inotify_event) <= static_cast<std::size_t>(amount)) {
+            auto event = reinterpret_cast<const inotify_event*>(buffer.data() + offset) ;
+            if ((event->mask & IN_IGNORED) != 0) {
+                // The directory went away, so has our watch
+                DBGMSG(std::cerr, "Configuration directory is no longer watched, polling it"s);
+                watching = false ;
+            }
+            else if (event->len > 0 && fileName == event->name) {
+                ours = true ;
+            }
+            offset += sizeof(inotify_event) + event->len ;
+        }
+    }
+#endif
+    return ours ;
+}
+
+//======================================================================
+auto ConfigWatcher::stop() -> void {
+    watching = false ;
+    if (settle != nullptr) {
+        settle->cancel() ;
+        settle = nullptr ;
+    }
+#if defined(__linux__)
+    if (descriptor != nullptr) {
+        // It closes the inotify descriptor
+        asio::error_code ec ;
+        descriptor->close(ec) ;
+        descriptor = nullptr ;
+    }
+    else if (inotify >= 0) {
+        ::close(inotify) ;
+    }
+#endif
+    inotify = -1 ;
+}
+
+//======================================================================
+auto ConfigWatcher::isWatching() const -> bool {
+    return watching ;
+}
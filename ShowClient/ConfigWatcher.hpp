@@ -0,0 +1,51 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef ConfigWatcher_hpp
+#define ConfigWatcher_hpp
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "asio.hpp"
+
+//======================================================================
+// Tells us when the configuration file is written, rather than us looking at
+// it every so often. It watches the directory (inotify), as editors often
+// write a new file and rename it over the old one. A save tends to be a few
+// events, so it waits for them to settle before calling. Everything runs on
+// the client's context. Where it can not watch (or the watch goes away),
+// isWatching is false and the file has to be polled.
+class ConfigWatcher {
+public:
+    using Changed = std::function<void()> ;
+    static constexpr auto SETTLE = std::chrono::milliseconds(250) ;
+
+private:
+    asio::io_context *context ;
+    std::string fileName ;
+    Changed changedRoutine ;
+    bool watching ;
+    int inotify ;
+#if defined(__linux__)
+    std::unique_ptr<asio::posix::stream_descriptor> descriptor ;
+#endif
+    std::unique_ptr<asio::steady_timer> settle ;
+
+    auto waitEvents() -> void ;
+    // True if any of them were for our file
+    auto readEvents() -> bool ;
+
+public:
+    ConfigWatcher() ;
+
+    // False if it can not be watched, and should be polled instead
+    auto start(asio::io_context &io_context, const std::filesystem::path &path, Changed routine) -> bool ;
+    // On the client's context, before it goes away
+    auto stop() -> void ;
+    auto isWatching() const -> bool ;
+};
+
+#endif /* ConfigWatcher_hpp */
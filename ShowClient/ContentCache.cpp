@@ -0,0 +1,358 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "ContentCache.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+#include "packets/FetchPacket.hpp"
+#include "packets/ChunkPacket.hpp"
+#include "utility/dbgutil.hpp"
+
+using namespace std::string_literals ;
+
+const std::string ContentCache::CACHEDIRECTORY = ".cache"s ;
+
+//======================================================================
+ContentCache::ContentCache():outstanding(false),busyCheck(nullptr),installedCount(0),failedCount(0),receivedBytes(0) {
+    
+}
+
+//======================================================================
+auto ContentCache::location(ManifestPacket::ContentType type) const -> Location {
+    auto lock = std::lock_guard(location_access) ;
+    if (type > ManifestPacket::LIGHT) {
+        return Location() ;
+    }
+    return locations[type] ;
+}
+
+//======================================================================
+auto ContentCache::target(const ManifestPacket::Entry &entry) const -> std::filesystem::path {
+    auto where = location(entry.type) ;
+    return where.path / (entry.name + where.extension) ;
+}
+
+//======================================================================
+auto ContentCache::object(const ManifestPacket::Entry &entry) const -> std::filesystem::path {
+    return location(entry.type).path / CACHEDIRECTORY / util::ContentHash::name(entry.hash) ;
+}
+
+//======================================================================
+auto ContentCache::partial(const ManifestPacket::Entry &entry) const -> std::filesystem::path {
+    return location(entry.type).path / CACHEDIRECTORY / (util::ContentHash::name(entry.hash) + ".part"s) ;
+}
+
+//======================================================================
+auto ContentCache::isInstalled(const ManifestPacket::Entry &entry) const -> bool {
+    auto ec = std::error_code() ;
+    auto path = target(entry) ;
+    auto cached = object(entry) ;
+    if (!std::filesystem::exists(path,ec) || !std::filesystem::exists(cached,ec)) {
+        return false ;
+    }
+    return std::filesystem::equivalent(path, cached, ec) ;
+}
+
+//======================================================================
+// Put the cached object in place under its name. The rename is the swap, so
+// anything opening the name gets either the old file or the new one.
+auto ContentCache::install(const ManifestPacket::Entry &entry) -> bool {
+    auto ec = std::error_code() ;
+    auto path = target(entry) ;
+    auto temp = std::filesystem::path(path.string() + ".tmp"s) ;
+    std::filesystem::remove(temp,ec) ;
+    std::filesystem::create_hard_link(object(entry), temp, ec) ;
+    if (ec) {
+        // Not every filesystem (FAT on a usb stick) can link
+        ec.clear() ;
+        std::filesystem::copy_file(object(entry), temp, ec) ;
+        if (ec) {
+            DBGMSG(std::cerr, "Unable to stage "s + temp.string() + ": "s + ec.message());
+            return false ;
+        }
+    }
+    std::filesystem::rename(temp, path, ec) ;
+    if (ec) {
+        DBGMSG(std::cerr, "Unable to install "s + path.string() + ": "s + ec.message());
+        std::filesystem::remove(temp,ec) ;
+        return false ;
+    }
+    installedCount += 1 ;
+    DBGMSG(std::cout, "Installed "s + path.string());
+    return true ;
+}
+
+//======================================================================
+// Work out where a fetch starts, returns false if there is nothing to fetch
+auto ContentCache::prepare(Pending &item) -> bool {
+    auto ec = std::error_code() ;
+    auto &entry = item.entry ;
+    auto cached = object(entry) ;
+    auto part = partial(entry) ;
+    std::filesystem::create_directories(cached.parent_path(), ec) ;
+    
+    if (std::filesystem::exists(cached,ec) && std::filesystem::file_size(cached,ec) == entry.size) {
+        install(entry) ;
+        return false ;
+    }
+    auto path = target(entry) ;
+    if (!std::filesystem::exists(part,ec) && std::filesystem::exists(path,ec) && std::filesystem::file_size(path,ec) == entry.size) {
+        // Someone put it there by hand, if it is right, adopt it rather than fetch it again
+        auto hash = util::ContentHash() ;
+        if (hash.updateFile(path) && hash.value == entry.hash) {
+            std::filesystem::create_hard_link(path, cached, ec) ;
+            if (ec) {
+                ec.clear() ;
+                std::filesystem::copy_file(path, cached, ec) ;
+            }
+            return false ;
+        }
+    }
+    item.received = 0 ;
+    item.hash.clear() ;
+    if (std::filesystem::exists(part,ec)) {
+        auto size = std::filesystem::file_size(part,ec) ;
+        if (ec || size > entry.size || !item.hash.updateFile(part, size)) {
+            std::filesystem::remove(part,ec) ;
+            item.hash.clear() ;
+        }
+        else {
+            item.received = size ;
+            DBGMSG(std::cout, "Resuming "s + entry.name + " at "s + std::to_string(size));
+        }
+    }
+    item.started = true ;
+    return true ;
+}
+
+//======================================================================
+auto ContentCache::finish(Pending &item) -> void {
+    auto ec = std::error_code() ;
+    auto part = partial(item.entry) ;
+    if (item.received != item.entry.size || item.hash.value != item.entry.hash) {
+        DBGMSG(std::cerr, "Content for "s + item.entry.name + " did not match its hash"s);
+        std::filesystem::remove(part,ec) ;
+        failedCount += 1 ;
+        return ;
+    }
+    std::filesystem::rename(part, object(item.entry), ec) ;
+    if (ec) {
+        DBGMSG(std::cerr, "Unable to cache "s + item.entry.name + ": "s + ec.message());
+        failedCount += 1 ;
+        return ;
+    }
+    install(item.entry) ;
+}
+
+//======================================================================
+// The manifest is the complete set, so anything else in the cache can go. The
+// music and lights can share a directory (and so a cache), so what is kept is
+// everything in the manifest, whatever its type, and each cache is gone
+// through once
+auto ContentCache::prune(const std::vector<ManifestPacket::Entry> &entries) -> void {
+    auto keep = std::unordered_set<std::string>() ;
+    for (const auto &entry : entries) {
+        keep.insert(util::ContentHash::name(entry.hash)) ;
+    }
+    auto done = std::vector<std::filesystem::path>() ;
+    for (auto type : {ManifestPacket::MUSIC, ManifestPacket::LIGHT}) {
+        auto where = location(type) ;
+        auto directory = where.path / CACHEDIRECTORY ;
+        auto ec = std::error_code() ;
+        if (where.path.empty() || !std::filesystem::is_directory(directory,ec)) {
+            continue ;
+        }
+        if (std::any_of(done.begin(), done.end(), [&directory](const std::filesystem::path &other){
+            auto error = std::error_code() ;
+            return std::filesystem::equivalent(directory, other, error) ;
+        })) {
+            continue ;
+        }
+        done.push_back(directory) ;
+        for (const auto &file : std::filesystem::directory_iterator(directory,ec)) {
+            // A .part has the hash as its stem too
+            if (keep.find(file.path().stem().string()) == keep.end()) {
+                auto error = std::error_code() ;
+                std::filesystem::remove(file.path(), error) ;
+            }
+        }
+    }
+}
+
+//======================================================================
+auto ContentCache::scheduleFetch() -> void {
+    if (outstanding || pending.empty() || fetchTimer == nullptr) {
+        return ;
+    }
+    auto delay = (busyCheck != nullptr && busyCheck()) ? std::chrono::milliseconds(BUSYDELAY) : std::chrono::milliseconds(0) ;
+    fetchTimer->expires_after(delay) ;
+    fetchTimer->async_wait([this](const asio::error_code &ec){
+        if (!ec) {
+            fetchNext() ;
+        }
+    });
+}
+
+//======================================================================
+auto ContentCache::fetchNext() -> void {
+    auto connection = client.lock() ;
+    if (outstanding || connection == nullptr || !connection->is_open()) {
+        return ;
+    }
+    while (!pending.empty()) {
+        auto &item = pending.front() ;
+        if (!item.started && !prepare(item)) {
+            pending.pop_front() ;
+            continue ;
+        }
+        if (item.received >= item.entry.size) {
+            finish(item) ;
+            pending.pop_front() ;
+            continue ;
+        }
+        auto amount = static_cast<std::uint32_t>(std::min<std::uint64_t>(CHUNKSIZE, item.entry.size - item.received)) ;
+        auto packet = FetchPacket(item.entry.type, item.entry.hash, item.received, amount) ;
+        outstanding = connection->send(packet) ;
+        return ;
+    }
+}
+
+//======================================================================
+auto ContentCache::setLocation(ManifestPacket::ContentType type, const std::filesystem::path &path, const std::string &extension) -> void {
+    if (type > ManifestPacket::LIGHT) {
+        return ;
+    }
+    auto lock = std::lock_guard(location_access) ;
+    locations[type].path = path ;
+    locations[type].extension = extension ;
+}
+
+//======================================================================
+auto ContentCache::setBusyCheck(BusyCheck function) -> void {
+    busyCheck = function ;
+}
+
+//======================================================================
+auto ContentCache::processManifest(ClientPointer connection, PacketPointer packet) -> bool {
+    auto payload = static_cast<ManifestPacket*>(packet.get()) ;
+    client = connection ;
+    if (fetchTimer == nullptr) {
+        fetchTimer = std::make_unique<asio::steady_timer>(connection->context()) ;
+    }
+    auto entries = payload->entries() ;
+    // Keep going on whatever is in flight if it is still wanted
+    auto current = pending.empty() ? std::uint64_t(0) : pending.front().entry.hash ;
+    auto keepCurrent = false ;
+    auto wanted = std::deque<Pending>() ;
+    for (const auto &entry : entries) {
+        if (entry.type > ManifestPacket::LIGHT || location(entry.type).path.empty()) {
+            continue ;
+        }
+        // The name is used as a file name, so nothing that could leave the directory
+        if (entry.name.empty() || entry.name[0] == '.' || entry.name.find_first_of("/\\:") != std::string::npos) {
+            DBGMSG(std::cerr, "Ignoring manifest entry: "s + entry.name);
+            continue ;
+        }
+        if (isInstalled(entry)) {
+            continue ;
+        }
+        if (!pending.empty() && entry.hash == current && entry.type == pending.front().entry.type && !keepCurrent) {
+            keepCurrent = true ;
+            wanted.push_front(pending.front()) ;
+            wanted.front().entry = entry ;
+            continue ;
+        }
+        wanted.push_back(Pending{entry,0,util::ContentHash(),false}) ;
+    }
+    if (!keepCurrent) {
+        // A chunk for what was in flight will not match anymore, so it is dropped
+        outstanding = false ;
+    }
+    pending = std::move(wanted) ;
+    prune(entries) ;
+    DBGMSG(std::cout, "Manifest: "s + std::to_string(entries.size()) + " entries, "s + std::to_string(pending.size()) + " to fetch"s);
+    scheduleFetch() ;
+    return true ;
+}
+
+//======================================================================
+auto ContentCache::processChunk(ClientPointer connection, PacketPointer packet) -> bool {
+    auto payload = static_cast<ChunkPacket*>(packet.get()) ;
+    if (pending.empty()) {
+        return true ;
+    }
+    auto &item = pending.front() ;
+    if (payload->hash() != item.entry.hash) {
+        // Left over from before a manifest changed what we want
+        return true ;
+    }
+    outstanding = false ;
+    if (payload->chunkOffset() != item.received) {
+        // Not the piece we asked for, ask again rather than wait on it
+        scheduleFetch() ;
+        return true ;
+    }
+    auto amount = payload->chunkSize() ;
+    if (amount == 0 || item.received + amount > item.entry.size) {
+        DBGMSG(std::cerr, "Server could not supply "s + item.entry.name);
+        failedCount += 1 ;
+        pending.pop_front() ;
+        scheduleFetch() ;
+        return true ;
+    }
+    auto ec = std::error_code() ;
+    auto size = std::filesystem::file_size(partial(item.entry), ec) ;
+    if ((ec && item.received != 0) || (!ec && size != item.received)) {
+        // The .part is not what we have hashed (it went away, or was changed
+        // under us), so start again from whatever is there now
+        DBGMSG(std::cerr, "Restarting "s + item.entry.name + ", its partial file changed"s);
+        item.started = false ;
+        scheduleFetch() ;
+        return true ;
+    }
+    auto output = std::ofstream(partial(item.entry).string(), std::ios::binary | std::ios::app) ;
+    if (!output.is_open() || !output.write(reinterpret_cast<const char*>(payload->chunk()), amount)) {
+        DBGMSG(std::cerr, "Unable to write "s + partial(item.entry).string());
+        failedCount += 1 ;
+        pending.pop_front() ;
+        scheduleFetch() ;
+        return true ;
+    }
+    output.close() ;
+    item.hash.update(payload->chunk(), amount) ;
+    item.received += amount ;
+    receivedBytes += amount ;
+    if (item.received >= item.entry.size) {
+        finish(item) ;
+        pending.pop_front() ;
+    }
+    scheduleFetch() ;
+    return true ;
+}
+
+//======================================================================
+auto ContentCache::cancel() -> void {
+    outstanding = false ;
+    pending.clear() ;
+    if (fetchTimer != nullptr) {
+        asio::error_code ec ;
+        fetchTimer->cancel(ec) ;
+    }
+}
+
+//======================================================================
+auto ContentCache::installed() const -> std::uint32_t {
+    return installedCount ;
+}
+
+//======================================================================
+auto ContentCache::failed() const -> std::uint32_t {
+    return failedCount ;
+}
+
+//======================================================================
+auto ContentCache::received() const -> std::uint64_t {
+    return receivedBytes ;
+}
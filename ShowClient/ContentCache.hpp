@@ -0,0 +1,95 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef ContentCache_hpp
+#define ContentCache_hpp
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "asio.hpp"
+
+#include "packets/Packet.hpp"
+#include "packets/ManifestPacket.hpp"
+#include "utility/hashutil.hpp"
+
+#include "Client.hpp"
+
+//======================================================================
+// Keeps the music/light directories in step with the server's MANIFEST.
+// Content is fetched a CHUNK at a time into <path>/.cache/<hash>.part, checked
+// against its hash, renamed to <path>/.cache/<hash>, and then linked (or copied)
+// over <path>/<name><extension> with a rename, so a LOAD only ever sees a
+// complete file. A .part survives a disconnect and the fetch resumes from it.
+// Everything runs on the client's context.
+class ContentCache {
+public:
+    static constexpr auto CHUNKSIZE = 32768 ;
+    // While a show is playing, we only ask for a chunk this often
+    static constexpr auto BUSYDELAY = std::chrono::milliseconds(250) ;
+    static const std::string CACHEDIRECTORY ;
+    using BusyCheck = std::function<bool()> ;
+    
+private:
+    struct Location {
+        std::filesystem::path path ;
+        std::string extension ;
+    };
+    struct Pending {
+        ManifestPacket::Entry entry ;
+        std::uint64_t received ;
+        util::ContentHash hash ;
+        bool started ;
+    };
+    
+    mutable std::mutex location_access ;
+    std::array<Location,2> locations ;
+    
+    std::deque<Pending> pending ;
+    bool outstanding ;
+    std::weak_ptr<Client> client ;
+    std::unique_ptr<asio::steady_timer> fetchTimer ;
+    BusyCheck busyCheck ;
+    
+    std::atomic<std::uint32_t> installedCount ;
+    std::atomic<std::uint32_t> failedCount ;
+    std::atomic<std::uint64_t> receivedBytes ;
+    
+    auto location(ManifestPacket::ContentType type) const -> Location ;
+    auto target(const ManifestPacket::Entry &entry) const -> std::filesystem::path ;
+    auto object(const ManifestPacket::Entry &entry) const -> std::filesystem::path ;
+    auto partial(const ManifestPacket::Entry &entry) const -> std::filesystem::path ;
+    auto isInstalled(const ManifestPacket::Entry &entry) const -> bool ;
+    auto install(const ManifestPacket::Entry &entry) -> bool ;
+    auto prepare(Pending &item) -> bool ;
+    auto finish(Pending &item) -> void ;
+    auto prune(const std::vector<ManifestPacket::Entry> &entries) -> void ;
+    auto scheduleFetch() -> void ;
+    auto fetchNext() -> void ;
+    
+public:
+    ContentCache() ;
+    
+    auto setLocation(ManifestPacket::ContentType type, const std::filesystem::path &path, const std::string &extension) -> void ;
+    // When this returns true, fetches are throttled to BUSYDELAY
+    auto setBusyCheck(BusyCheck function) -> void ;
+    
+    auto processManifest(ClientPointer connection, PacketPointer packet) -> bool ;
+    auto processChunk(ClientPointer connection, PacketPointer packet) -> bool ;
+    // The connection went away; any .part is kept for the next manifest
+    auto cancel() -> void ;
+    
+    auto installed() const -> std::uint32_t ;
+    auto failed() const -> std::uint32_t ;
+    auto received() const -> std::uint64_t ;
+};
+
+#endif /* ContentCache_hpp */
@@ -0,0 +1,139 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "DeadlineTimer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+//======================================================================
+DeadlineTimer::DeadlineTimer():running(true),expiry(std::chrono::steady_clock::time_point::max()),generation(0),expiredRoutine(nullptr),spinBudget(std::chrono::duration_cast<std::chrono::nanoseconds>(DEFAULTSPIN).count()),wakeError(0) {
+}
+
+//======================================================================
+DeadlineTimer::~DeadlineTimer() {
+    {
+        auto lock = std::lock_guard(access) ;
+        running = false ;
+        generation += 1 ;
+    }
+    wakeup.notify_all() ;
+    if (timerThread.joinable()) {
+        timerThread.join() ;
+    }
+}
+
+//======================================================================
+auto DeadlineTimer::startThread() -> void {
+    if (!timerThread.joinable()) {
+        timerThread = std::thread(&DeadlineTimer::runThread,this) ;
+    }
+}
+
+//======================================================================
+auto DeadlineTimer::setExpired(Expired routine) -> void {
+    auto lock = std::lock_guard(access) ;
+    expiredRoutine = routine ;
+}
+
+//======================================================================
+auto DeadlineTimer::setSpinBudget(std::chrono::microseconds budget) -> void {
+    spinBudget = std::chrono::duration_cast<std::chrono::nanoseconds>(std::max(budget, std::chrono::microseconds(0))).count() ;
+}
+
+//======================================================================
+auto DeadlineTimer::setRealtime(bool realtime) -> bool {
+#if defined(__linux__)
+    {
+        auto lock = std::lock_guard(access) ;
+        if (!realtime && !timerThread.joinable()) {
+            // Nothing to take it off
+            return true ;
+        }
+        startThread() ;
+    }
+    auto param = sched_param{} ;
+    param.sched_priority = realtime ? REALTIMEPRIORITY : 0 ;
+    return ::pthread_setschedparam(timerThread.native_handle(), realtime ? SCHED_FIFO : SCHED_OTHER, &param) == 0 ;
+#else
+    return !realtime ;
+#endif
+}
+
+//======================================================================
+auto DeadlineTimer::expiresAt(std::chrono::steady_clock::time_point when) -> void {
+    {
+        auto lock = std::lock_guard(access) ;
+        expiry = when ;
+        generation += 1 ;
+        if (when != std::chrono::steady_clock::time_point::max()) {
+            startThread() ;
+        }
+    }
+    wakeup.notify_all() ;
+}
+
+//======================================================================
+auto DeadlineTimer::cancel() -> void {
+    expiresAt(std::chrono::steady_clock::time_point::max()) ;
+}
+
+//======================================================================
+auto DeadlineTimer::sleepUntil(std::chrono::steady_clock::time_point when) -> void {
+#if defined(__linux__)
+    // steady_clock is CLOCK_MONOTONIC here, its epoch is the clock's
+    auto since = std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch()).count() ;
+    auto target = timespec{static_cast<time_t>(since / 1000000000), static_cast<long>(since % 1000000000)} ;
+    while (::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR) {
+    }
+#else
+    std::this_thread::sleep_until(when) ;
+#endif
+}
+
+//======================================================================
+auto DeadlineTimer::runThread() -> void {
+    auto lock = std::unique_lock(access) ;
+    while (running) {
+        if (expiry == std::chrono::steady_clock::time_point::max()) {
+            wakeup.wait(lock) ;
+            continue ;
+        }
+        auto target = expiry ;
+        auto armed = generation ;
+        auto budget = std::chrono::nanoseconds(spinBudget.load()) ;
+        auto spin = budget.count() == 0 ? budget : std::min(budget, wakeError + SPINMARGIN) ;
+        auto wake = target - spin ;
+        // Far off, wait where a new expiry can get to us
+        if (wakeup.wait_until(lock, wake - COARSE, [this,armed]{ return generation != armed ; })) {
+            continue ;
+        }
+        lock.unlock() ;
+        if (std::chrono::steady_clock::now() < wake) {
+            sleepUntil(wake) ;
+            // A late wake up counts in full, then fades, so the spin covers the bad ones
+            auto error = std::max(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wake), std::chrono::nanoseconds(0)) ;
+            wakeError = std::max(error, wakeError - (wakeError / SPINDECAY)) ;
+        }
+        while (std::chrono::steady_clock::now() < target) {
+        }
+        lock.lock() ;
+        if (generation != armed) {
+            continue ;
+        }
+        expiry = std::chrono::steady_clock::time_point::max() ;
+        auto routine = expiredRoutine ;
+        lock.unlock() ;
+        auto next = routine != nullptr ? routine(target) : std::chrono::steady_clock::time_point::max() ;
+        lock.lock() ;
+        // Unless someone set (or cancelled) it while we were out
+        if (generation == armed) {
+            expiry = next ;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef DeadlineTimer_hpp
+#define DeadlineTimer_hpp
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+//======================================================================
+// A timer for frame deadlines, on its own thread. It sleeps (clock_nanosleep
+// on an absolute CLOCK_MONOTONIC time, where there is one) until a little
+// before the deadline, then spins the rest of the way. How early it wakes
+// follows how late the sleeps have been coming back, up to the spin budget.
+// The expired routine is given the deadline it was due at, and returns the
+// next one (time_point::max() for none). The thread is started the first time
+// it is needed, not when the timer is made.
+class DeadlineTimer {
+public:
+    using Expired = std::function<std::chrono::steady_clock::time_point(std::chrono::steady_clock::time_point)> ;
+
+    static constexpr auto DEFAULTSPIN = std::chrono::microseconds(1000) ;
+    // SCHED_FIFO priority when real time, above the kernel's irq threads (50)
+    static constexpr auto REALTIMEPRIORITY = 60 ;
+
+private:
+    // Waits further out than this are on the condition variable, where a new
+    // expiry wakes them. Anything closer is one sleep, so a frame is one wake
+    // up (a cancel still drops it, an earlier expiry waits for it)
+    static constexpr auto COARSE = std::chrono::milliseconds(50) ;
+    // Spin this much longer than the worst wake up we expect
+    static constexpr auto SPINMARGIN = std::chrono::microseconds(50) ;
+    // The expected wake up error forgets a late one by 1/SPINDECAY a wait
+    static constexpr auto SPINDECAY = 32 ;
+
+    std::mutex access ;
+    std::condition_variable wakeup ;
+    std::thread timerThread ;
+    bool running ;
+    // max() when not armed. A new expiry (or cancel) bumps the generation,
+    // so whatever the thread was waiting on is dropped
+    std::chrono::steady_clock::time_point expiry ;
+    std::uint64_t generation ;
+    Expired expiredRoutine ;
+
+    std::atomic<std::int64_t> spinBudget ;
+    // Only touched on the timer thread
+    std::chrono::nanoseconds wakeError ;
+
+    // With access held
+    auto startThread() -> void ;
+    auto runThread() -> void ;
+    auto sleepUntil(std::chrono::steady_clock::time_point when) -> void ;
+
+public:
+    DeadlineTimer() ;
+    ~DeadlineTimer() ;
+
+    auto setExpired(Expired routine) -> void ;
+    // The most it will spin, zero to only sleep
+    auto setSpinBudget(std::chrono::microseconds budget) -> void ;
+    // Run the thread with real time scheduling (or not), false if we are not allowed to
+    auto setRealtime(bool realtime) -> bool ;
+    auto expiresAt(std::chrono::steady_clock::time_point when) -> void ;
+    auto cancel() -> void ;
+};
+
+#endif /* DeadlineTimer_hpp */
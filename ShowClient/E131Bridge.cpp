@@ -0,0 +1,343 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "E131Bridge.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#include "network/KernelTimestamp.hpp"
+#include "utility/dbgutil.hpp"
+
+#include "ClientStatistics.hpp"
+
+using namespace std::string_literals ;
+
+namespace {
+    //======================================================================
+    auto get16(const std::uint8_t *data, std::size_t offset) -> std::uint16_t {
+        return static_cast<std::uint16_t>((data[offset] << 8) | data[offset + 1]) ;
+    }
+    
+    //======================================================================
+    auto get32(const std::uint8_t *data, std::size_t offset) -> std::uint32_t {
+        return (static_cast<std::uint32_t>(get16(data, offset)) << 16) | get16(data, offset + 2) ;
+    }
+    
+    //======================================================================
+    // The root layer both packet kinds share
+    auto isE131(const std::uint8_t *data, std::size_t length) -> bool {
+        static const std::uint8_t identifier[12] = {'A','S','C','-','E','1','.','1','7',0,0,0} ;
+        return length >= 38 && get16(data, 0) == 0x0010 && std::memcmp(data + 4, identifier, sizeof(identifier)) == 0 ;
+    }
+    
+    constexpr std::uint32_t VECTOR_ROOT_DATA = 0x00000004 ;
+    constexpr std::uint32_t VECTOR_ROOT_EXTENDED = 0x00000008 ;
+    constexpr std::uint32_t VECTOR_DATA_PACKET = 0x00000002 ;
+    constexpr std::uint32_t VECTOR_EXTENDED_SYNC = 0x00000001 ;
+    constexpr std::uint8_t OPTION_PREVIEW = 0x80 ;
+    constexpr std::uint8_t OPTION_TERMINATED = 0x40 ;
+    constexpr auto SLOTOFFSET = 126 ;
+    constexpr auto SYNCSIZE = 49 ;
+}
+
+//======================================================================
+E131Bridge::E131Bridge():udpSocket(io_context),running(false),reportInterval(0) {
+    
+}
+
+//======================================================================
+E131Bridge::~E131Bridge() {
+    this->stop() ;
+}
+
+//======================================================================
+auto E131Bridge::start(const std::vector<UniverseConfig> &configs) -> bool {
+    this->stop() ;
+    universes.clear() ;
+    lookup.clear() ;
+    syncSeen.clear() ;
+    auto size = 0 ;
+    for (const auto &config : configs) {
+        if (config.protocol != UniverseConfig::E131) {
+            DBGMSG(std::cerr, "Only E1.31 universes can be input, ignoring universe "s + std::to_string(config.universe));
+            continue ;
+        }
+        if (lookup.find(static_cast<std::uint16_t>(config.universe)) != lookup.end()) {
+            continue ;
+        }
+        auto entry = Universe() ;
+        entry.config = config ;
+        entry.hasSource = false ;
+        entry.priority = 0 ;
+        entry.sequence = 0 ;
+        entry.syncAddress = 0 ;
+        entry.held = false ;
+        entry.received = 0 ;
+        entry.lost = 0 ;
+        entry.stale = 0 ;
+        entry.ignored = 0 ;
+        lookup.insert_or_assign(static_cast<std::uint16_t>(config.universe), universes.size()) ;
+        universes.push_back(entry) ;
+        size = std::max(size, config.inputOffset + config.length) ;
+    }
+    if (universes.empty()) {
+        return true ;
+    }
+#if defined(__linux__)
+    frame = std::vector<std::uint8_t>(static_cast<std::size_t>(size), 0) ;
+    try {
+        udpSocket.open(asio::ip::udp::v4()) ;
+        udpSocket.set_option(asio::socket_base::reuse_address(true)) ;
+        udpSocket.set_option(asio::socket_base::receive_buffer_size(1024 * 1024)) ;
+        udpSocket.bind(asio::ip::udp::endpoint(asio::ip::address_v4::any(), E131PORT)) ;
+    }
+    catch (const std::exception &e) {
+        DBGMSG(std::cerr, "Unable to open E1.31 input: "s + e.what());
+        asio::error_code ec ;
+        udpSocket.close(ec) ;
+        return false ;
+    }
+    for (const auto &entry : universes) {
+        // Each universe's multicast group is 239.255.hi.lo, on the interface given (or the default)
+        asio::error_code ec ;
+        auto group = asio::ip::make_address_v4(asio::ip::address_v4::uint_type(0xefff0000 | entry.config.universe)) ;
+        auto interface = entry.config.address.empty() ? asio::ip::address_v4::any() : asio::ip::make_address_v4(entry.config.address, ec) ;
+        if (!ec) {
+            udpSocket.set_option(asio::ip::multicast::join_group(group, interface), ec) ;
+        }
+        if (ec) {
+            DBGMSG(std::cerr, "Unable to join universe "s + std::to_string(entry.config.universe) + ": "s + ec.message());
+        }
+    }
+    auto handle = udpSocket.native_handle() ;
+    KernelTimestamp::enable(handle) ;
+    // Wake up to see if we have been stopped
+    auto timeout = timeval{0, 250000} ;
+    ::setsockopt(handle, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) ;
+    
+    buffers.resize(BATCH) ;
+    messages.resize(BATCH) ;
+    vectors.resize(BATCH) ;
+    controls.resize(BATCH) ;
+    for (auto index = 0 ; index < BATCH ; index++) {
+        vectors[index].iov_base = buffers[index].data() ;
+        vectors[index].iov_len = buffers[index].size() ;
+        std::memset(&messages[index], 0, sizeof(mmsghdr)) ;
+        messages[index].msg_hdr.msg_iov = &vectors[index] ;
+        messages[index].msg_hdr.msg_iovlen = 1 ;
+        messages[index].msg_hdr.msg_control = controls[index].data() ;
+    }
+    running = true ;
+    bridgeThread = std::thread(&E131Bridge::runThread,this) ;
+    return true ;
+#else
+    DBGMSG(std::cerr, "E1.31 input is only available on Linux");
+    return false ;
+#endif
+}
+
+//======================================================================
+auto E131Bridge::stop() -> void {
+    running = false ;
+    if (bridgeThread.joinable()) {
+        bridgeThread.join() ;
+    }
+    asio::error_code ec ;
+    udpSocket.close(ec) ;
+}
+
+//======================================================================
+auto E131Bridge::isRunning() const -> bool {
+    return running ;
+}
+
+//======================================================================
+auto E131Bridge::setOutputRoutine(FrameOutput function) -> void {
+    outputRoutine = function ;
+}
+
+//======================================================================
+auto E131Bridge::setReportInterval(int seconds) -> void {
+    reportInterval = seconds ;
+}
+
+//======================================================================
+auto E131Bridge::runThread() -> void {
+#if defined(__linux__)
+    auto handle = udpSocket.native_handle() ;
+    auto lastReport = std::chrono::steady_clock::now() ;
+    while (running) {
+        for (auto &message : messages) {
+            message.msg_hdr.msg_controllen = CMSG_SPACE(sizeof(timespec)) ;
+            message.msg_hdr.msg_flags = 0 ;
+        }
+        // Wait for one, then take whatever else is already queued
+        auto count = ::recvmmsg(handle, messages.data(), BATCH, MSG_WAITFORONE, nullptr) ;
+        auto now = std::chrono::steady_clock::now() ;
+        if (count < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                DBGMSG(std::cerr, "E1.31 input error: "s + std::strerror(errno));
+                std::this_thread::sleep_for(std::chrono::milliseconds(250)) ;
+            }
+        }
+        else {
+            auto changed = false ;
+            auto stamped = false ;
+            auto earliest = util::ourclock::time_point::max() ;
+            for (auto index = 0 ; index < count ; index++) {
+                const auto *data = buffers[index].data() ;
+                auto length = static_cast<std::size_t>(messages[index].msg_len) ;
+                if (!isE131(data, length)) {
+                    continue ;
+                }
+                auto used = false ;
+                switch (get32(data, 18)) {
+                    case VECTOR_ROOT_DATA:
+                        used = processData(data, length, now) ;
+                        break ;
+                    case VECTOR_ROOT_EXTENDED:
+                        used = processSync(data, length, now) ;
+                        break ;
+                    default:
+                        break ;
+                }
+                if (!used) {
+                    continue ;
+                }
+                changed = true ;
+                auto &hdr = messages[index].msg_hdr ;
+                for (auto header = CMSG_FIRSTHDR(&hdr) ; header != nullptr ; header = CMSG_NXTHDR(&hdr, header)) {
+                    if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_TIMESTAMPNS) {
+                        auto arrival = timespec() ;
+                        std::memcpy(&arrival, CMSG_DATA(header), sizeof(arrival)) ;
+                        auto stamp = util::ourclock::time_point(std::chrono::duration_cast<util::ourclock::duration>(std::chrono::seconds(arrival.tv_sec) + std::chrono::nanoseconds(arrival.tv_nsec))) ;
+                        earliest = std::min(earliest, stamp) ;
+                        stamped = true ;
+                    }
+                }
+            }
+            if (changed) {
+                output(earliest, stamped) ;
+            }
+        }
+        if (reportInterval > 0 && now - lastReport >= std::chrono::seconds(reportInterval)) {
+            report() ;
+            lastReport = now ;
+        }
+    }
+#endif
+}
+
+//======================================================================
+auto E131Bridge::processData(const std::uint8_t *data, std::size_t length, std::chrono::steady_clock::time_point now) -> bool {
+    if (length < SLOTOFFSET || get32(data, 40) != VECTOR_DATA_PACKET || data[117] != 0x02 || data[125] != 0) {
+        // Not DMX (alternate start codes, like per slot priority, are not for us)
+        return false ;
+    }
+    auto iter = lookup.find(get16(data, 113)) ;
+    if (iter == lookup.end()) {
+        return false ;
+    }
+    auto &entry = universes[iter->second] ;
+    auto options = data[112] ;
+    if ((options & OPTION_PREVIEW) != 0) {
+        return false ;
+    }
+    const auto *cid = data + 22 ;
+    auto same = entry.hasSource && std::equal(entry.source.begin(), entry.source.end(), cid) ;
+    if ((options & OPTION_TERMINATED) != 0) {
+        if (same) {
+            entry.hasSource = false ;
+            entry.held = false ;
+        }
+        return false ;
+    }
+    auto priority = std::min<std::uint8_t>(data[108], 200) ;
+    auto sequence = data[111] ;
+    auto expired = entry.hasSource && now - entry.lastSeen > SOURCETIMEOUT ;
+    if (!entry.hasSource || expired || (!same && priority > entry.priority)) {
+        // A new source to follow, whatever its sequence is
+        std::copy(cid, cid + 16, entry.source.begin()) ;
+        entry.hasSource = true ;
+        entry.held = false ;
+    }
+    else if (!same) {
+        // Someone else at the same or a lower priority
+        entry.ignored += 1 ;
+        return false ;
+    }
+    else {
+        auto delta = static_cast<std::int8_t>(sequence - entry.sequence) ;
+        if (delta <= 0 && delta > -20) {
+            entry.stale += 1 ;
+            return false ;
+        }
+        if (delta > 1) {
+            entry.lost += static_cast<std::uint64_t>(delta - 1) ;
+            ClientStatistics::instance().recordBridgeLoss(static_cast<std::uint32_t>(delta - 1)) ;
+        }
+    }
+    entry.priority = priority ;
+    entry.sequence = sequence ;
+    entry.lastSeen = now ;
+    entry.received += 1 ;
+    
+    auto slots = std::min<std::size_t>({static_cast<std::size_t>(std::max(get16(data, 123) - 1, 0)), length - SLOTOFFSET, static_cast<std::size_t>(entry.config.length)}) ;
+    std::memcpy(frame.data() + entry.config.inputOffset, data + SLOTOFFSET, slots) ;
+    
+    entry.syncAddress = get16(data, 109) ;
+    if (entry.syncAddress != 0) {
+        auto seen = syncSeen.find(entry.syncAddress) ;
+        if (seen != syncSeen.end() && now - seen->second <= SOURCETIMEOUT) {
+            // Goes out with the sync packet
+            entry.held = true ;
+            return false ;
+        }
+    }
+    return true ;
+}
+
+//======================================================================
+auto E131Bridge::processSync(const std::uint8_t *data, std::size_t length, std::chrono::steady_clock::time_point now) -> bool {
+    if (length < SYNCSIZE || get32(data, 40) != VECTOR_EXTENDED_SYNC) {
+        return false ;
+    }
+    auto address = get16(data, 45) ;
+    syncSeen.insert_or_assign(address, now) ;
+    auto released = false ;
+    for (auto &entry : universes) {
+        if (entry.held && entry.syncAddress == address) {
+            entry.held = false ;
+            released = true ;
+        }
+    }
+    return released ;
+}
+
+//======================================================================
+auto E131Bridge::output(util::ourclock::time_point earliest, bool stamped) -> void {
+    if (outputRoutine != nullptr) {
+        outputRoutine(frame.data(), static_cast<int>(frame.size())) ;
+    }
+    auto latency = stamped ? std::chrono::duration_cast<std::chrono::microseconds>(util::ourclock::now() - earliest) : std::chrono::microseconds(-1) ;
+    ClientStatistics::instance().recordBridgeFrame(latency) ;
+}
+
+//======================================================================
+auto E131Bridge::report() -> void {
+    for (auto &entry : universes) {
+        if (entry.received == 0 && entry.lost == 0 && entry.stale == 0 && entry.ignored == 0) {
+            continue ;
+        }
+        DBGMSG(std::cout, "E1.31 universe "s + std::to_string(entry.config.universe) + ": received "s + std::to_string(entry.received) + " lost "s + std::to_string(entry.lost) + " stale "s + std::to_string(entry.stale) + " ignored "s + std::to_string(entry.ignored));
+        entry.received = 0 ;
+        entry.lost = 0 ;
+        entry.stale = 0 ;
+        entry.ignored = 0 ;
+    }
+}
@@ -0,0 +1,105 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef E131Bridge_hpp
+#define E131Bridge_hpp
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "asio.hpp"
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#endif
+
+#include "utility/timeutil.hpp"
+#include "UniverseConfig.hpp"
+
+//======================================================================
+// Takes E1.31 (sACN) universes off the network and hands them on as one light
+// frame, each universe's slots at its offset, so another sequencer can run the
+// lights. It runs on its own thread, pulling whatever is queued with one
+// recvmmsg, and outputs as soon as a batch changed a universe (or, for
+// universes with a synchronization address, when the sync packet comes).
+// Per universe it follows the highest priority source and drops out of order
+// sequence numbers.
+class E131Bridge {
+public:
+    using FrameOutput = std::function<void(const std::uint8_t*,int)> ;
+    
+    static constexpr std::uint16_t E131PORT = 5568 ;
+    static constexpr auto PACKETSIZE = 638 ;
+    static constexpr auto BATCH = 32 ;
+    // A source (or sync address) silent this long is gone
+    static constexpr auto SOURCETIMEOUT = std::chrono::milliseconds(2500) ;
+    
+private:
+    struct Universe {
+        UniverseConfig config ;
+        std::array<std::uint8_t,16> source ;
+        bool hasSource ;
+        std::uint8_t priority ;
+        std::uint8_t sequence ;
+        std::chrono::steady_clock::time_point lastSeen ;
+        std::uint16_t syncAddress ;
+        // Slots are in the frame, waiting on a sync packet
+        bool held ;
+        
+        std::uint64_t received ;
+        std::uint64_t lost ;
+        std::uint64_t stale ;
+        std::uint64_t ignored ;
+    };
+    
+    asio::io_context io_context ;
+    asio::ip::udp::socket udpSocket ;
+    std::thread bridgeThread ;
+    std::atomic<bool> running ;
+    
+    std::vector<Universe> universes ;
+    std::unordered_map<std::uint16_t,std::size_t> lookup ;
+    std::unordered_map<std::uint16_t,std::chrono::steady_clock::time_point> syncSeen ;
+    std::vector<std::uint8_t> frame ;
+    
+    std::vector<std::array<std::uint8_t,PACKETSIZE>> buffers ;
+#if defined(__linux__)
+    std::vector<mmsghdr> messages ;
+    std::vector<iovec> vectors ;
+    std::vector<std::array<std::uint8_t,CMSG_SPACE(sizeof(timespec))>> controls ;
+#endif
+    
+    FrameOutput outputRoutine ;
+    std::atomic<int> reportInterval ;
+    
+    auto runThread() -> void ;
+    // True if the frame changed and can go out now
+    auto processData(const std::uint8_t *data, std::size_t length, std::chrono::steady_clock::time_point now) -> bool ;
+    // True if a held universe was released
+    auto processSync(const std::uint8_t *data, std::size_t length, std::chrono::steady_clock::time_point now) -> bool ;
+    auto output(util::ourclock::time_point earliest, bool stamped) -> void ;
+    auto report() -> void ;
+    
+public:
+    E131Bridge() ;
+    ~E131Bridge() ;
+    
+    // Joins the universes and starts receiving, an empty list stops. Not thread safe with itself
+    auto start(const std::vector<UniverseConfig> &configs) -> bool ;
+    auto stop() -> void ;
+    auto isRunning() const -> bool ;
+    
+    // Where frames go, called on the bridge thread
+    auto setOutputRoutine(FrameOutput function) -> void ;
+    // Seconds between the per universe counts in the log, 0 for none
+    auto setReportInterval(int seconds) -> void ;
+};
+
+#endif /* E131Bridge_hpp */
@@ -3,12 +3,13 @@
 #include "IOController.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include "utility/dbgutil.hpp"
 
 using namespace std::string_literals;
 
 // =======================================================================
-IOController::IOController():is_loaded(false),has_error(false),is_enabled(false),current_frame(0),is_playing(false){
+IOController::IOController():is_loaded(false),has_error(false),is_enabled(false),current_frame(0),frame_period(FRAMEPERIOD),is_playing(false),first_output(0),statistics_output(ClientStatistics::LIGHT),sync_seen(0),max_slew(1.0){
     
 }
 
@@ -71,26 +72,88 @@ auto IOController::clear() -> void {
 }
 
 // ======================================================================
-auto IOController::syncFrame(int sync_frame) -> void {
-    auto lock = std::lock_guard(frame_access);
-    auto delta = current_frame - sync_frame ;
-    if (std::abs(delta) < 3) {
+auto IOController::syncFrame(double sync_frame) -> void {
+    sync_mailbox.post(sync_frame, std::chrono::steady_clock::now()) ;
+    if (isPlaying()) {
         return ;
     }
-    if (std::abs(delta) < 6) {
-        if (delta > 0) {
-            current_frame -= 1 ;
-            
-        }
-        else {
-            current_frame += 1 ;
-            
-        }
+    // Nothing to steer, just be there when we start. Only ever tried, so a
+    // start that has the lock is not held up (the next SYNC will do)
+    auto lock = std::unique_lock(frame_access, std::try_to_lock) ;
+    if (lock.owns_lock() && !isPlaying()) {
+        current_frame = static_cast<int>(std::lround(sync_frame)) ;
     }
-    else {
+}
+
+// ======================================================================
+auto IOController::resetSync() -> void {
+    discipline.reset() ;
+    sync_seen = sync_mailbox.latest() ;
+}
+
+// ======================================================================
+// Small offsets are slewed out by running our frames a little long or short,
+// only a big one jumps the frame
+auto IOController::takeSync(std::chrono::steady_clock::time_point now) -> void {
+    auto posted = 0.0 ;
+    auto when = std::chrono::steady_clock::time_point() ;
+    if (!sync_mailbox.take(sync_seen, posted, when) || !isPlaying()) {
+        return ;
+    }
+    // Where the server is now, it has moved on since it was posted
+    auto sync_frame = posted + (std::chrono::duration<double,std::nano>(now - when).count() / frame_period.count()) ;
+    auto offset = framePosition(now) - sync_frame ;
+    if (discipline.update(offset, sync_frame) == SyncDiscipline::STEP) {
+        auto delta = static_cast<int>(std::lround(offset)) ;
+        ClientStatistics::instance().recordSync(delta) ;
         //DBGMSG(std::cout, "Resetting from to sync: "s + std::to_string(syncFrame));
-        current_frame = sync_frame ;
+        userStep(sync_frame, offset) ;
     }
+    userSetRate(discipline.rate()) ;
+    ClientStatistics::instance().recordDiscipline(statistics_output, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<double,std::nano>(discipline.offset() * frame_period.count())), discipline.drift()) ;
+}
+
+// ======================================================================
+auto IOController::userStep(double sync_frame, double offset) -> void {
+    current_frame -= static_cast<int>(std::lround(offset)) ;
     userSetSync(current_frame);
 }
 
+// ======================================================================
+auto IOController::setSyncTuning(const SyncDiscipline::Tuning &tuning) -> void {
+    auto capped = tuning ;
+    capped.slew = std::min(tuning.slew, max_slew) ;
+    auto lock = std::lock_guard(frame_access);
+    discipline.setTuning(capped) ;
+}
+
+// =======================================================================
+auto IOController::startAt(int frame, std::chrono::steady_clock::time_point at, std::chrono::nanoseconds period) -> bool {
+    if (!prepare(frame, period)) {
+        return false ;
+    }
+    return commit(at) ;
+}
+
+// =======================================================================
+// Only the first call after a start counts, returns true if this was it
+auto IOController::markFirstOutput(std::chrono::steady_clock::time_point when) -> bool {
+    auto expected = std::int64_t(0) ;
+    auto value = std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch()).count() ;
+    return first_output.compare_exchange_strong(expected, value) ;
+}
+
+// =======================================================================
+auto IOController::startLanding() const -> std::chrono::microseconds {
+    auto first = first_output.load() ;
+    if (first == 0) {
+        return std::chrono::microseconds(0) ;
+    }
+    auto when = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(first))) ;
+    return std::chrono::duration_cast<std::chrono::microseconds>(when - start_target) ;
+}
+
+// =======================================================================
+auto IOController::hasFirstOutput() const -> bool {
+    return first_output != 0 ;
+}
@@ -3,15 +3,24 @@
 #ifndef IOController_hpp
 #define IOController_hpp
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <mutex>
 #include <filesystem>
 
+#include "ClientStatistics.hpp"
+#include "SyncDiscipline.hpp"
+#include "SyncMailbox.hpp"
+
 class IOController {
     
 protected:
     mutable std::mutex frame_access ;
     int current_frame;
+    // How long a frame is, taken from the light file being played
+    std::chrono::nanoseconds frame_period ;
     
     bool is_loaded ;
     bool has_error ;
@@ -21,11 +30,36 @@ protected:
     std::filesystem::path data_location ;
     std::string data_extension ;
     std::string data_name ;
+    
+    // When the first frame/sample of a start should go out, and when it did
+    std::chrono::steady_clock::time_point start_target ;
+    std::atomic<std::int64_t> first_output ;    // steady clock ns, 0 until it happens
+    auto markFirstOutput(std::chrono::steady_clock::time_point when) -> bool ;
   
+    // Follows the server's SYNCs, reported as this output. They arrive in the
+    // mailbox, and are taken on our own thread at a frame (or buffer) boundary
+    SyncDiscipline discipline ;
+    ClientStatistics::Output statistics_output ;
+    SyncMailbox sync_mailbox ;
+    std::uint64_t sync_seen ;
+    // The most this output can correct its rate by, the tuning's slew is held to it
+    double max_slew ;
+    // With frame_access held. resetSync forgets anything posted so far
+    auto resetSync() -> void ;
+    auto takeSync(std::chrono::steady_clock::time_point now) -> void ;
+    
     virtual auto userSetEnabled(bool state) -> void {}
     virtual auto userSetSync(int syncframe) -> void{} 
+    // These are called with frame_access held. Where we are (fractional) right
+    // now, and the fraction to lengthen our frame period by
+    virtual auto framePosition(std::chrono::steady_clock::time_point now) const -> double { return current_frame ; }
+    virtual auto userSetRate(double rate) -> void {}
+    // A big offset (from sync_frame, where the server is now) is jumped. By
+    // default the frame moves by the whole frames we are off
+    virtual auto userStep(double sync_frame, double offset) -> void ;
 public:
-    static constexpr int FRAMEPERIOD = 37 ;
+    // The period for anything that does not say otherwise
+    static constexpr auto FRAMEPERIOD = std::chrono::nanoseconds(37000000) ;
 
     IOController() ;
     virtual ~IOController();
@@ -41,11 +75,26 @@ public:
     auto setDataInformation(const std::filesystem::path &location, const std::string &extension) -> void ;
     
     virtual auto load(const std::string &dataname) -> bool = 0;
-    virtual auto start(int frame  ,int frame_period ) -> bool = 0;
+    virtual auto start(int frame  ,std::chrono::nanoseconds period ) -> bool = 0;
+    
+    // Starting is two steps, so several outputs can begin together. prepare
+    // does everything slow (opening devices, positioning), commit just says
+    // when frame begins and can be called right before that instant.
+    virtual auto prepare(int frame, std::chrono::nanoseconds period) -> bool = 0 ;
+    virtual auto commit(std::chrono::steady_clock::time_point at) -> bool = 0 ;
+    auto startAt(int frame, std::chrono::steady_clock::time_point at, std::chrono::nanoseconds period = FRAMEPERIOD) -> bool ;
     virtual auto stop() -> void ;
     virtual auto clear() -> void ;
     
-    auto syncFrame(int sync_frame) -> void ;
+    // Where the server is (fractional) right now. Never blocks, the output
+    // catches up with it on its next period. One that is not playing just
+    // takes the frame
+    auto syncFrame(double sync_frame) -> void ;
+    auto setSyncTuning(const SyncDiscipline::Tuning &tuning) -> void ;
+    
+    // How far the first output of the last start landed from its target (0 until it has happened)
+    auto startLanding() const -> std::chrono::microseconds ;
+    auto hasFirstOutput() const -> bool ;
 };
 
 
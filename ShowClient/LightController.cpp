@@ -2,55 +2,94 @@
 
 #include "LightController.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
 #include "utility/dbgutil.hpp"
 #include "utility/strutil.hpp"
 
-using namespace std::string_literals ;
+#include "ClientStatistics.hpp"
 
-// ===============================================================================
-auto LightController::runThread() -> void {
-    io_context.run() ;
-}
+using namespace std::string_literals ;
 
 // ==================================================================================================
-auto LightController::tick(const asio::error_code &ec,asio::steady_timer* timer ) -> void {
-    if (ec != asio::error::operation_aborted) {
-        auto frame = 0 ;
-        {
-            auto lock = std::lock_guard(frame_access);
+auto LightController::tick(std::chrono::steady_clock::time_point due) -> std::chrono::steady_clock::time_point {
+    auto now = std::chrono::steady_clock::now() ;
+    auto late = std::chrono::duration_cast<std::chrono::microseconds>(now - due) ;
+    ClientStatistics::instance().recordTick(late, std::chrono::duration_cast<std::chrono::microseconds>(frame_period)) ;
+    if (markFirstOutput(now)) {
+        ClientStatistics::instance().recordLanding(ClientStatistics::LIGHT, late) ;
+    }
+    auto frame = 0 ;
+    auto next = std::chrono::steady_clock::time_point() ;
+    {
+        auto lock = std::lock_guard(frame_access);
+        // Against the frame we were on, before moving on from it
+        takeSync(now) ;
+        last_tick = due ;
+        auto position = 0.0 ;
+        auto clocked = frame_clock != nullptr && frame_clock(now, position) ;
+        if (clocked) {
+            // Where the audio is, against where our timer alone says we are
+            auto nominal = start_frame + 1 + (std::chrono::duration<double,std::nano>(now - start_target).count() / frame_period.count()) ;
+            drift = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::duration<double,std::nano>((position - nominal) * frame_period.count())) ;
+            drift_max = std::max(drift_max, drift < std::chrono::microseconds(0) ? -drift : drift) ;
+            drift_valid = true ;
+            ClientStatistics::instance().recordDrift(drift) ;
+        }
+        if (clocked && follow_clock) {
+            // Show the audio's frame, and wake up when it reaches the next one
+            current_frame = static_cast<int>(std::lround(position)) ;
+            auto remaining = (static_cast<double>(current_frame) + 1.0 - position) * frame_period.count() ;
+            anchor_frame = current_frame + 1 ;
+            anchor_time = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double,std::nano>(remaining)) ;
+        }
+        else {
             current_frame += 1 ;
-            frame = current_frame ;
         }
-        updateLight(frame);
-        auto time = timer->expiry() ;
-        timer->expires_at(time + std::chrono::milliseconds(framePeriod)) ;
-        timer->async_wait(std::bind(&LightController::tick,this,std::placeholders::_1,timer) );
+        frame = current_frame ;
+        next = deadline(current_frame + 1) ;
     }
+    updateLight(frame);
+    return next ;
+}
 
+// ===============================================================================
+auto LightController::mapPrus() -> void {
+    std::call_once(pru_once,[this](){
+        auto first = std::make_unique<BlinkPru>(PruNumber::zero) ;
+        auto second = std::make_unique<BlinkPru>(PruNumber::one) ;
+        first->setConfig(config0) ;
+        second->setConfig(config1) ;
+        pru0 = std::move(first) ;
+        pru1 = std::move(second) ;
+    });
 }
 
 // ===============================================================================
 auto LightController::userSetEnabled(bool value) -> void {
     if (value) {
+        this->mapPrus() ;
         // Lets check our firmware
 #if defined (BEAGLE)
         //DBGMSG(std::cout, "checking firmware for pru 0");
-        if(!pru0.checkFirmware()) {
-            throw std::runtime_error("Incorrect firmware in pru 0: "s + pru0.firmware());
+        if(!pru0->checkFirmware()) {
+            throw std::runtime_error("Incorrect firmware in pru 0: "s + pru0->firmware());
         }
         //DBGMSG(std::cout, "checking state for pru 0");
-        if (!pru0.checkState()) {
+        if (!pru0->checkState()) {
             //DBGMSG(std::cout, "Throwing check state exception for pru 0");
-            throw std::runtime_error("Incorrect state in pru 0: "s + pru0.state());
+            throw std::runtime_error("Incorrect state in pru 0: "s + pru0->state());
         }
         //DBGMSG(std::cout, "checking firmware for pru 1");
-        if(!pru1.checkFirmware()) {
-            throw std::runtime_error("Incorrect firmware in pru 1: "s + pru1.firmware());
+        if(!pru1->checkFirmware()) {
+            throw std::runtime_error("Incorrect firmware in pru 1: "s + pru1->firmware());
         }
         //DBGMSG(std::cout, "checking state for pru 1");
-        if (!pru1.checkState()) {
+        if (!pru1->checkState()) {
             //DBGMSG(std::cout, "Throwing check state exception for pru 1");
-            throw std::runtime_error("Incorrect state in pru 1: "s + pru1.state());
+            throw std::runtime_error("Incorrect state in pru 1: "s + pru1->state());
         }
 #endif
     }
@@ -70,34 +109,65 @@ auto LightController::clearLoaded() -> void {
     is_loaded = false ;
     has_error = false ;
 #if defined(BEAGLE)
-    pru0.clear();
-    pru1.clear();
+    if (pru0 != nullptr) {
+        pru0->clear();
+        pru1->clear();
+    }
 #endif
+    network.blackout() ;
 }
 
 // ===============================================================================
-auto LightController::updatePRU(BlinkPru &pru,int offset,const std::uint8_t *data,int length) -> void {
+auto LightController::updatePRU(BlinkPru *pru,int offset,const std::uint8_t *data,int length) -> void {
 #if defined(BEAGLE)
     auto pru_length  = length - offset ;
-    if (pru_length <= 0 ) {
+    if (pru == nullptr || pru_length <= 0 ) {
         return ;
     }
-    pru.setData(data+offset, pru_length);
+    pru->setData(data+offset, pru_length);
     
 #endif
 }
 
 // ===============================================================================
 auto LightController::updateLight(int frame ) -> void {
-#if defined(BEAGLE)
     auto [data,length] = this->dataForFrame(frame);
     if (data != nullptr && length != 0 ){
         
         //DBGMSG(std::cout, "We are telling pru to write: "s + std::to_string(length));
-        this->updatePRU(pru0, config0.inputOffset, data, length);
-        this->updatePRU(pru1, config1.inputOffset, data, length);
+        this->updatePRU(pru0.get(), config0.inputOffset, data, length);
+        this->updatePRU(pru1.get(), config1.inputOffset, data, length);
+        network.send(data, length) ;
     }
-#endif
+}
+
+// ===============================================================================
+// With frame_access held
+auto LightController::deadline(int frame) const -> std::chrono::steady_clock::time_point {
+    auto span = std::chrono::duration<double,std::nano>(static_cast<double>(frame - anchor_frame) * frame_period.count() * period_scale) ;
+    return anchor_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(span) ;
+}
+
+// ===============================================================================
+auto LightController::framePosition(std::chrono::steady_clock::time_point now) const -> double {
+    if (!is_playing) {
+        return current_frame ;
+    }
+    return current_frame + (std::chrono::duration<double,std::nano>(now - last_tick).count() / (frame_period.count() * period_scale)) ;
+}
+
+// ===============================================================================
+auto LightController::userSetRate(double rate) -> void {
+    // The frame on now keeps its start, the new rate applies from there
+    anchor_frame = current_frame ;
+    anchor_time = last_tick ;
+    period_scale = 1.0 + rate ;
+}
+
+// ===============================================================================
+auto LightController::userSetSync(int syncframe) -> void {
+    anchor_frame = syncframe ;
+    anchor_time = last_tick ;
 }
 
 // ===============================================================================
@@ -111,31 +181,74 @@ auto LightController::dataForFrame(int frame) -> std::pair<const std::uint8_t*,i
     return std::make_pair(ptr, length);
 }
 // ===============================================================================
-LightController::LightController():IOController(),timer(io_context), pru0(PruNumber::zero), pru1(PruNumber::one), framePeriod(FRAMEPERIOD){
-    
-    timerThread = std::thread(&LightController::runThread,this) ;
+LightController::LightController():IOController(), pru0(nullptr), pru1(nullptr), period_scale(1.0),anchor_frame(0),frame_clock(nullptr),follow_clock(false),start_frame(0),drift_valid(false),drift(0),drift_max(0){
+    timer.setExpired(std::bind(&LightController::tick,this,std::placeholders::_1)) ;
 }
 
 // ===============================================================================
 LightController::~LightController(){
-    try {
-        timer.cancel();
-    }
-    catch(...){}
-    if (!io_context.stopped()) {
-        io_context.stop() ;
-    }
-    if (timerThread.joinable()){
-        timerThread.join();
-    }
+    timer.cancel();
 }
 
 // ===============================================================================
 auto LightController::setPRUInfo(const PRUConfig &config0,const PRUConfig &config1)-> void {
     this->config0 = config0 ;
     this->config1 = config1 ;
-    pru0.setConfig(config0);
-    pru1.setConfig(config1);
+    if (pru0 != nullptr) {
+        pru0->setConfig(config0);
+        pru1->setConfig(config1);
+    }
+}
+
+// ===============================================================================
+auto LightController::setUniverses(const std::vector<UniverseConfig> &universes, const std::string &name) -> void {
+    network.configure(universes, "ShowClient "s + name) ;
+}
+
+// ===============================================================================
+auto LightController::setFrameClock(FrameClock clock, bool follow) -> void {
+    auto lock = std::lock_guard(frame_access) ;
+    frame_clock = clock ;
+    follow_clock = follow ;
+}
+
+// =============================================================================
+auto LightController::setTimerSpin(std::chrono::microseconds budget) -> void {
+    timer.setSpinBudget(budget) ;
+}
+
+// =============================================================================
+auto LightController::setRealtime(bool realtime) -> bool {
+    return timer.setRealtime(realtime) ;
+}
+
+// =============================================================================
+auto LightController::filePeriod() const -> std::chrono::nanoseconds {
+    if (is_loaded) {
+        return lightFile.framePeriod() ;
+    }
+    return FRAMEPERIOD ;
+}
+
+// =============================================================================
+auto LightController::periodOf(const std::string &name) const -> std::chrono::nanoseconds {
+    if (name.empty()) {
+        return FRAMEPERIOD ;
+    }
+    auto input = std::ifstream(data_location / std::filesystem::path(name + data_extension), std::ios::binary) ;
+    if (!input.is_open()) {
+        return FRAMEPERIOD ;
+    }
+    try {
+        auto header = LightHeader(input) ;
+        if (input.good() && header.sampleRate != 0) {
+            return std::chrono::milliseconds(header.sampleRate) ;
+        }
+    }
+    catch(...) {
+        // Not a light file we know, no better than the default
+    }
+    return FRAMEPERIOD ;
 }
 
 // =============================================================================
@@ -146,11 +259,52 @@ auto LightController::loadBuffer(const std::vector<std::uint8_t> &data) -> bool
     if (isPlaying()){
         return false ;
     }
-    pru0.setData(data.data(), static_cast<int>(data.size()));
-    pru1.setData(data.data(), static_cast<int>(data.size()));
+    data_buffer = data ;
+    if (pru0 != nullptr) {
+        pru0->setData(data_buffer.data(), static_cast<int>(data_buffer.size()));
+        pru1->setData(data_buffer.data(), static_cast<int>(data_buffer.size()));
+    }
+    network.send(data_buffer.data(), static_cast<int>(data_buffer.size())) ;
     return true ;
 }
 
+// =============================================================================
+auto LightController::loadBuffer(const ZBufferPacket &packet) -> bool {
+    if (!is_enabled){
+        return true;
+    }
+    if (isPlaying()){
+        return false ;
+    }
+    auto begin = std::chrono::steady_clock::now() ;
+    if (!packet.decode(data_buffer)) {
+        // Whatever is left is not a frame anything can be applied to, until the server sends a whole one
+        data_buffer.clear() ;
+        return false ;
+    }
+    ClientStatistics::instance().recordDecode(packet.encodedSize(), packet.decodedSize(), std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin)) ;
+    if (pru0 != nullptr) {
+        pru0->setData(data_buffer.data(), static_cast<int>(data_buffer.size()));
+        pru1->setData(data_buffer.data(), static_cast<int>(data_buffer.size()));
+    }
+    network.send(data_buffer.data(), static_cast<int>(data_buffer.size())) ;
+    return true ;
+}
+
+// =============================================================================
+auto LightController::showFrame(const std::uint8_t *data, int length) -> void {
+    if (!is_enabled || is_playing) {
+        return ;
+    }
+    this->updatePRU(pru0.get(), config0.inputOffset, data, length);
+    this->updatePRU(pru1.get(), config1.inputOffset, data, length);
+}
+
+// =============================================================================
+auto LightController::buffer() const -> const std::vector<std::uint8_t>& {
+    return data_buffer ;
+}
+
 // =============================================================================
 auto LightController::load(const std::string &name) -> bool {
     clearLoaded() ;
@@ -171,40 +325,65 @@ auto LightController::load(const std::string &name) -> bool {
     return is_loaded;
 }
 // ===============================================================================
-auto LightController::start(int frame, int period ) -> bool {
-    framePeriod = period ;
+auto LightController::start(int frame, std::chrono::nanoseconds period ) -> bool {
+    return startAt(frame, std::chrono::steady_clock::now(), period) ;
+}
+
+// ===============================================================================
+auto LightController::prepare(int frame, std::chrono::nanoseconds period) -> bool {
     is_playing = false ;
-    if ( !is_enabled ) {
-        // We are going to respond yes, because we swallow this if we are not enabled
-        is_playing = true ;
-    }
-    
-    else if (has_error){
+    if (is_enabled && has_error){
         return false ;
     }
-    try{ timer.cancel();}catch(...){} ;
+    timer.cancel() ;
     {
         auto lock = std::lock_guard(frame_access) ;
         current_frame = frame ;
-        
+        start_frame = frame ;
+        frame_period = period ;
+        period_scale = 1.0 ;
+        resetSync() ;
+        drift_valid = false ;
+        drift = std::chrono::microseconds(0) ;
+        drift_max = std::chrono::microseconds(0) ;
     }
-    
-    timer.expires_at(std::chrono::steady_clock::now() + std::chrono::milliseconds(framePeriod));
-    timer.async_wait(std::bind(&LightController::tick,this,std::placeholders::_1,&timer) );
+    return true ;
+}
+
+// ===============================================================================
+// The first tick shows frame + 1, one period after frame begins
+auto LightController::commit(std::chrono::steady_clock::time_point at) -> bool {
+    first_output = 0 ;
+    {
+        auto lock = std::lock_guard(frame_access) ;
+        last_tick = at ;
+        anchor_frame = current_frame ;
+        anchor_time = at ;
+        start_target = deadline(current_frame + 1) ;
+    }
+    timer.expiresAt(start_target) ;
     is_playing = true ;
     return is_playing ;
 }
 // ===============================================================================
 auto LightController::stop() -> void {
     if (is_playing){
-        try {timer.cancel();} catch(...){}
+        timer.cancel() ;
+        auto lock = std::lock_guard(frame_access) ;
+        if (drift_valid) {
+            DBGMSG(std::cout, "Audio drift over "s + data_name + ": "s + std::to_string(drift.count()) + " us at frame "s + std::to_string(current_frame) + ", max "s + std::to_string(drift_max.count()) + " us"s);
+            drift_valid = false ;
+        }
     }
     is_playing = false ;
     
 #if defined(BEAGLE)
-    pru0.clear();
-    pru1.clear();
+    if (pru0 != nullptr) {
+        pru0->clear();
+        pru1->clear();
+    }
 #endif
+    network.blackout() ;
 
 }
 
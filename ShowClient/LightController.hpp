@@ -9,38 +9,69 @@
 #include <vector>
 #include <mutex>
 #include <filesystem>
+#include <memory>
 #include <utility>
 
-#include "asio.hpp"
-
 #include "bone/BlinkPru.hpp"
+#include "packets/ZBufferPacket.hpp"
 #include "lightfile/lightfile.hpp"
 #include "PRUConfig.hpp"
+#include "DeadlineTimer.hpp"
 #include "IOController.hpp"
+#include "NetworkOutput.hpp"
+#include "UniverseConfig.hpp"
 
 class LightController : public IOController {
-    BlinkPru pru0 ;
-    BlinkPru pru1 ;
+public:
+    // The frame (fractional) another output is at, at a time. False if it has none right now
+    using FrameClock = std::function<bool(std::chrono::steady_clock::time_point,double&)> ;
+private:
+    // Mapped when lights are first enabled (mapping writes the pru memory), so
+    // never where they are not used. Null until then
+    std::unique_ptr<BlinkPru> pru0 ;
+    std::unique_ptr<BlinkPru> pru1 ;
+    std::once_flag pru_once ;
+    auto mapPrus() -> void ;
+    // E1.31/Art-Net universes, sent alongside the prus
+    NetworkOutput network ;
     
-    std::thread timerThread ;
-    auto runThread() -> void ;
-
-    asio::io_context io_context;
-    asio::executor_work_guard<asio::io_context::executor_type> timerguard{asio::make_work_guard(io_context)} ;
-    asio::steady_timer timer ;
-    auto tick(const asio::error_code &ec,asio::steady_timer* timer ) -> void ;
+    DeadlineTimer timer ;
+    // Shows the next frame, returns when the one after is due
+    auto tick(std::chrono::steady_clock::time_point due) -> std::chrono::steady_clock::time_point ;
+    
+    // The sync loop's correction, and when the frame we are on began
+    double period_scale ;
+    std::chrono::steady_clock::time_point last_tick ;
+    // Ticks are scheduled from here (anchor_frame went out at anchor_time), not
+    // from the last one, so rounding never adds up. Moved whenever the rate or
+    // the frame changes
+    int anchor_frame ;
+    std::chrono::steady_clock::time_point anchor_time ;
+    auto deadline(int frame) const -> std::chrono::steady_clock::time_point ;
+    auto framePosition(std::chrono::steady_clock::time_point now) const -> double final ;
+    auto userSetRate(double rate) -> void final ;
+    auto userSetSync(int syncframe) -> void final ;
     
-    int framePeriod ;
+    // With follow_clock the frame shown comes from frame_clock (the audio) and
+    // the timer just wakes us at its frame boundaries. Either way it is used to
+    // measure how far the audio drifts from our timer.
+    FrameClock frame_clock ;
+    bool follow_clock ;
+    int start_frame ;
+    bool drift_valid ;
+    std::chrono::microseconds drift ;
+    std::chrono::microseconds drift_max ;
     
     LightFile lightFile ;
     PRUConfig config0 ;
     PRUConfig config1 ;
+    // The last buffer sent to the prus, what a delta ZBUFFER applies to
     std::vector<std::uint8_t> data_buffer ;
     
     auto userSetEnabled(bool state) -> void final;
 
     auto clearLoaded() -> void ;
-    auto updatePRU(BlinkPru &pru,int offset,const std::uint8_t *data,int length) -> void ;
+    auto updatePRU(BlinkPru *pru,int offset,const std::uint8_t *data,int length) -> void ;
     auto updateLight(int frame) -> void ;
     auto dataForFrame(int frame) -> std::pair<const std::uint8_t*,int>  ;
  public:
@@ -50,11 +81,27 @@ class LightController : public IOController {
     // Unique onese
     
     auto setPRUInfo(const PRUConfig &config0,const PRUConfig &config1)-> void ;
+    auto setUniverses(const std::vector<UniverseConfig> &universes, const std::string &name) -> void ;
+    auto setFrameClock(FrameClock clock, bool follow) -> void ;
+    auto setTimerSpin(std::chrono::microseconds budget) -> void ;
+    auto setRealtime(bool realtime) -> bool ;
+    // The frame period of the loaded light file (the default if none)
+    auto filePeriod() const -> std::chrono::nanoseconds ;
+    // The frame period in the named light file's header, without loading it
+    // (so even with the lights off). The default if it can't be read
+    auto periodOf(const std::string &name) const -> std::chrono::nanoseconds ;
     auto loadBuffer(const std::vector<std::uint8_t> &data) -> bool ;
+    auto loadBuffer(const ZBufferPacket &packet) -> bool ;
+    // A frame from somewhere else (the E1.31 bridge) straight to the prus, while no show is playing
+    auto showFrame(const std::uint8_t *data, int length) -> void ;
+    // The last buffer loaded
+    auto buffer() const -> const std::vector<std::uint8_t>& ;
     
 
     auto load(const std::string &name) -> bool final ;
-    auto start(int frame,int period = IOController::FRAMEPERIOD) -> bool  final;
+    auto start(int frame,std::chrono::nanoseconds period = IOController::FRAMEPERIOD) -> bool  final;
+    auto prepare(int frame, std::chrono::nanoseconds period = IOController::FRAMEPERIOD) -> bool final ;
+    auto commit(std::chrono::steady_clock::time_point at) -> bool final ;
     auto stop() -> void final ;
     auto clear() -> void final ;
 };
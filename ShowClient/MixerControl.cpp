@@ -53,7 +53,7 @@ auto setVolume(long volume) -> long {
 
 #else
 
-auto setVolume(int card, long volume) -> long {
+auto setVolume(long volume) -> long {
     return volume;
 }
 #endif
@@ -3,12 +3,15 @@
 #include "MusicController.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <stdexcept>
 
 #include "utility/dbgutil.hpp"
 #include "utility/timeutil.hpp"
 #include "utility/strutil.hpp"
 #include "MixerControl.hpp"
+#include "ClientStatistics.hpp"
 using namespace std::string_literals;
 
 /* ************************************************************************************************************************************
@@ -82,9 +85,21 @@ auto MusicController::deviceExists(int device) -> bool {
 }
 
 // ==========================================================================================
-MusicController::MusicController():IOController(),bufferFrames(1632),my_device(0),musicErrorCallback(nullptr){
-    soundDac.showWarnings(false);
-    soundDac.setErrorCallback( std::bind( &MusicController::errorCallback, this, std::placeholders::_1, std::placeholders::_2) );
+MusicController::MusicController():IOController(),soundDac(nullptr),dac_made(false),my_device(0),bufferFrames(1632),prepared(false),output_latency(0),stream_rate(44100),clock_valid(false),clock_sample(0),rate_adjust(0.0),sample_debt(0.0),musicErrorCallback(nullptr){
+    statistics_output = ClientStatistics::AUDIO ;
+    max_slew = MAXSLEW ;
+    setSyncTuning(SyncDiscipline::Tuning()) ;
+}
+
+// ======================================================================
+auto MusicController::dac() -> RtAudio& {
+    std::call_once(dac_once,[this](){
+        soundDac = std::make_unique<RtAudio>() ;
+        soundDac->showWarnings(false);
+        soundDac->setErrorCallback( std::bind( &MusicController::errorCallback, this, std::placeholders::_1, std::placeholders::_2) );
+        dac_made = true ;
+    });
+    return *soundDac ;
 }
 // ======================================================================
 MusicController::~MusicController() {
@@ -98,17 +113,18 @@ MusicController::~MusicController() {
 
 // ======================================================================
 auto MusicController::initialize(int device, std::uint32_t sampleRate )-> bool {
-    if (soundDac.isStreamOpen()){
-        soundDac.closeStream();
+    if (dac_made && soundDac->isStreamOpen()){
+        soundDac->closeStream();
     }
     //DBGMSG(std::cout, "We think our device is "s + std::to_string(device)) ;
     if (!is_enabled){
         return true ;
     }
+    auto &sound = dac() ;
     has_error = false ;
     if (device == 0) {
         // get the default device
-        device = MusicController::getDefaultDevice() ;
+        device = sound.getDefaultOutputDevice() ;
         //DBGMSG(std::cout, "Default device is: "s + std::to_string(device)) ;
     }
     if (device == 0) {
@@ -118,7 +134,8 @@ auto MusicController::initialize(int device, std::uint32_t sampleRate )-> bool {
         return false ;
     }
     // Make sure this device exists ?
-    if (!MusicController::deviceExists(device)) {
+    auto devices = sound.getDeviceIds() ;
+    if (std::find(devices.begin(), devices.end(), device) == devices.end()) {
         //DBGMSG(std::cout, "Return false because: Does not exist device: "s + std::to_string(device));
 
         has_error = true ;
@@ -126,12 +143,12 @@ auto MusicController::initialize(int device, std::uint32_t sampleRate )-> bool {
     }
     my_device = device ;
     // Device exists, we are set and ready
-    if (soundDac.isStreamOpen()) {
+    if (sound.isStreamOpen()) {
         this->stop() ;
     }
     rtParameters.deviceId = device ;
     rtParameters.nChannels = 2 ;
-    auto status = soundDac.openStream(&rtParameters, NULL, RTAUDIO_SINT16, sampleRate, &bufferFrames, &MusicController::rtCallback,this) ;
+    auto status = sound.openStream(&rtParameters, NULL, RTAUDIO_SINT16, sampleRate, &bufferFrames, &MusicController::rtCallback,this) ;
     if (status == RTAUDIO_SYSTEM_ERROR ) {
         has_error = true ;
         return false ;
@@ -146,7 +163,7 @@ auto MusicController::initialize(int device, std::uint32_t sampleRate )-> bool {
 }
 // ======================================================================================================================
 auto MusicController::isPlaying() const -> bool {
-    return soundDac.isStreamRunning() ;
+    return dac_made && soundDac->isStreamRunning() ;
 }
 
 
@@ -175,19 +192,31 @@ auto MusicController::load(const std::string &musicname) -> bool {
 
 // ======================================================================
 auto MusicController::stop() -> void {
-    if (soundDac.isStreamOpen()) {
-        if (soundDac.isStreamRunning()) {
-            soundDac.abortStream() ;
+    if (dac_made && soundDac->isStreamOpen()) {
+        if (soundDac->isStreamRunning()) {
+            soundDac->abortStream() ;
         }
-        soundDac.closeStream() ;
+        soundDac->closeStream() ;
     }
+    prepared = false ;
     is_playing = false ;
+    {
+        auto lock = std::lock_guard(frame_access);
+        clock_valid = false ;
+    }
 }
 
 
 
 // ======================================================================
-auto MusicController::start(std::int32_t frame ,int period ) -> bool {
+auto MusicController::start(std::int32_t frame ,std::chrono::nanoseconds period ) -> bool {
+    // Begin as soon as the stream is open
+    return startAt(frame, std::chrono::steady_clock::now(), period) ;
+}
+
+// ======================================================================
+auto MusicController::prepare(int frame, std::chrono::nanoseconds period) -> bool {
+    prepared = false ;
     if (has_error) {
         return false ;
     }
@@ -199,6 +228,12 @@ auto MusicController::start(std::int32_t frame ,int period ) -> bool {
     {
         auto lock = std::lock_guard(frame_access);
         current_frame = frame ;
+        frame_period = period ;
+        clock_valid = false ;
+        rate_adjust = 0.0 ;
+        sample_debt = 0.0 ;
+        resetSync() ;
+        musicFile.setFramePeriod(period) ;
         musicFile.setFrame(frame) ;
     }
     // Now, start the playing
@@ -206,9 +241,35 @@ auto MusicController::start(std::int32_t frame ,int period ) -> bool {
         has_error = true ;
         return false ;
     }
-    soundDac.startStream() ;
-    
-    return soundDac.isStreamRunning() ;
+    auto &sound = dac() ;
+    stream_rate = sound.getStreamSampleRate() ;
+    if (stream_rate == 0) {
+        stream_rate = musicFile.sampleRate() ;
+    }
+    output_latency = std::chrono::nanoseconds((static_cast<std::int64_t>(sound.getStreamLatency()) * 1000000000) / std::max<std::int64_t>(stream_rate,1)) ;
+    // So the callback never allocates (a callback owes at most a couple of samples)
+    resample_buffer.resize((static_cast<std::size_t>(bufferFrames) + 8) * SAMPLESIZE) ;
+    {
+        // Silence until we are told when
+        auto lock = std::lock_guard(frame_access);
+        start_target = std::chrono::steady_clock::time_point::max() ;
+        first_output = 0 ;
+    }
+    sound.startStream() ;
+    prepared = sound.isStreamRunning() ;
+    return prepared ;
+}
+
+// ======================================================================
+auto MusicController::commit(std::chrono::steady_clock::time_point at) -> bool {
+    if (!prepared) {
+        // Nothing to start (disabled, or nothing loaded)
+        return true ;
+    }
+    auto lock = std::lock_guard(frame_access);
+    start_target = at ;
+    prepared = false ;
+    return true ;
 }
 
 // ======================================================================
@@ -216,15 +277,161 @@ auto MusicController::clear() -> void {
     this->clearLoaded();
 }
 
+// ======================================================================
+// Called (with frame_access held) until the first real sample goes out.
+// Silence pads out a start that is still ahead (or not committed yet), and a
+// late start skips what should already have played. Returns the samples of padding.
+auto MusicController::alignFirstBuffer(std::uint8_t *data, std::uint32_t frameCount) -> std::uint32_t {
+    // When what we write now will actually be heard
+    auto heard = std::chrono::steady_clock::now() + output_latency ;
+    auto padding = std::uint32_t(0) ;
+    if (heard < start_target) {
+        auto span = std::chrono::nanoseconds((static_cast<std::int64_t>(frameCount) * 1000000000) / stream_rate) ;
+        padding = frameCount ;
+        if (start_target - heard < span) {
+            auto early = std::chrono::duration_cast<std::chrono::nanoseconds>(start_target - heard).count() ;
+            padding = static_cast<std::uint32_t>(std::min<std::int64_t>((early * stream_rate) / 1000000000, frameCount)) ;
+        }
+        std::fill(data, data + (padding * SAMPLESIZE), 0) ;
+        if (padding == frameCount) {
+            return padding ;
+        }
+        heard += std::chrono::nanoseconds((static_cast<std::int64_t>(padding) * 1000000000) / stream_rate) ;
+    }
+    else {
+        auto late = std::chrono::duration_cast<std::chrono::nanoseconds>(heard - start_target).count() ;
+        musicFile.skip(static_cast<std::uint32_t>((late * stream_rate) / 1000000000)) ;
+    }
+    markFirstOutput(heard) ;
+    ClientStatistics::instance().recordLanding(ClientStatistics::AUDIO, std::chrono::duration_cast<std::chrono::microseconds>(heard - start_target)) ;
+    return padding ;
+}
+
+// ======================================================================
+// Called (with frame_access held) with when the next sample from the file will be heard
+auto MusicController::updateClock(std::chrono::steady_clock::time_point heard) -> void {
+    auto sample = musicFile.position() ;
+    if (clock_valid) {
+        // Where the last measurement says this sample should be heard
+        auto elapsed = (static_cast<std::int64_t>(sample) - static_cast<std::int64_t>(clock_sample)) * 1000000000 / std::max<std::int64_t>(musicFile.sampleRate(),1) ;
+        auto predicted = clock_heard + std::chrono::nanoseconds(elapsed) ;
+        auto error = heard - predicted ;
+        // A big error is a jump (a sync moved us, an underrun), not jitter
+        if (error < CLOCKSTEP && error > -CLOCKSTEP) {
+            heard = predicted + (error / CLOCKFILTER) ;
+        }
+    }
+    clock_sample = sample ;
+    clock_heard = heard ;
+    clock_valid = true ;
+}
+
+// ======================================================================
+auto MusicController::audioFrame(std::chrono::steady_clock::time_point at, double &frame) const -> bool {
+    auto lock = std::lock_guard(frame_access);
+    return clockFrame(at, frame) ;
+}
+
+// ======================================================================
+auto MusicController::clockFrame(std::chrono::steady_clock::time_point at, double &frame) const -> bool {
+    if (!clock_valid) {
+        return false ;
+    }
+    auto rate = static_cast<double>(musicFile.sampleRate()) ;
+    auto sample = static_cast<double>(clock_sample) + (std::chrono::duration<double>(at - clock_heard).count() * rate) ;
+    frame = sample / (rate * std::chrono::duration<double>(frame_period).count()) ;
+    return true ;
+}
+
+// ======================================================================
+auto MusicController::framePosition(std::chrono::steady_clock::time_point now) const -> double {
+    auto frame = 0.0 ;
+    if (clockFrame(now, frame)) {
+        return frame ;
+    }
+    return current_frame ;
+}
+
+// ======================================================================
+auto MusicController::userSetRate(double rate) -> void {
+    rate_adjust = std::clamp(rate, -MAXSLEW, MAXSLEW) ;
+}
+
+// ======================================================================
+// From the callback, just before the next buffer is read. That buffer is heard
+// an output latency from now, so it starts where the server will be then, to
+// the sample. The clock is measured again from there
+auto MusicController::userStep(double sync_frame, double offset) -> void {
+    auto samplesPerFrame = static_cast<double>(musicFile.sampleRate()) * std::chrono::duration<double>(frame_period).count() ;
+    auto latency = std::chrono::duration<double,std::nano>(output_latency).count() / static_cast<double>(frame_period.count()) ;
+    auto sample = std::max(std::llround((sync_frame + latency) * samplesPerFrame), 0LL) ;
+    musicFile.seek(static_cast<std::uint32_t>(std::min<long long>(sample, std::numeric_limits<std::uint32_t>::max()))) ;
+    current_frame = static_cast<int>(static_cast<double>(musicFile.position()) / samplesPerFrame) ;
+    clock_valid = false ;
+    sample_debt = 0.0 ;
+}
+
+// ======================================================================
+// With frame_access held. owed samples more (negative, fewer) of the file are
+// played over count, stretched by linear interpolation
+auto MusicController::loadStretched(std::uint8_t *data, std::uint32_t count, std::int64_t owed) -> std::uint32_t {
+    auto source = static_cast<std::int64_t>(count) - owed ;
+    if (owed == 0 || count < 2 || source < 2 || static_cast<std::size_t>(source) * SAMPLESIZE > resample_buffer.size()) {
+        return musicFile.loadBuffer(data, count) ;
+    }
+    auto read = musicFile.loadBuffer(resample_buffer.data(), static_cast<std::uint32_t>(source)) ;
+    if (read < source) {
+        // The end of the file, nothing to keep in step with
+        std::copy(resample_buffer.data(), resample_buffer.data() + (read * SAMPLESIZE), data) ;
+        return read ;
+    }
+    auto input = reinterpret_cast<const std::int16_t*>(resample_buffer.data()) ;
+    auto output = reinterpret_cast<std::int16_t*>(data) ;
+    auto step = static_cast<double>(source - 1) / static_cast<double>(count - 1) ;
+    for (auto sample = std::uint32_t(0) ; sample < count ; sample++) {
+        auto position = sample * step ;
+        auto index = std::min(static_cast<std::int64_t>(position), source - 2) ;
+        auto fraction = position - static_cast<double>(index) ;
+        for (auto channel = 0 ; channel < 2 ; channel++) {
+            auto first = static_cast<double>(input[(index * 2) + channel]) ;
+            auto second = static_cast<double>(input[((index + 1) * 2) + channel]) ;
+            output[(sample * 2) + channel] = static_cast<std::int16_t>(std::lround(first + ((second - first) * fraction))) ;
+        }
+    }
+    return count ;
+}
+
 // Our two callbacks
 // ======================================================================
 auto MusicController::requestData(std::uint8_t *data,std::uint32_t frameCount, double time, RtAudioStreamFlags status ) -> int {
-    if (!soundDac.isStreamRunning() || !soundDac.isStreamOpen() ) {
+    if (!soundDac->isStreamRunning() || !soundDac->isStreamOpen() ) {
         return 2 ;
     }
+    if (status & RTAUDIO_OUTPUT_UNDERFLOW) {
+        ClientStatistics::instance().recordUnderrun() ;
+    }
     auto lock = std::lock_guard(frame_access);
-    auto amount = musicFile.loadBuffer(data, frameCount) ;
-    current_frame += 1 ;
+    auto padding = std::uint32_t(0) ;
+    if (first_output == 0) {
+        padding = alignFirstBuffer(data, frameCount) ;
+        if (padding == frameCount) {
+            // All silence, the start is still ahead of us
+            return 0 ;
+        }
+    }
+    takeSync(std::chrono::steady_clock::now()) ;
+    auto owed = std::int64_t(0) ;
+    if (rate_adjust != 0.0) {
+        // Positive is running ahead: play fewer of the file's samples
+        sample_debt += rate_adjust * (frameCount - padding) ;
+        owed = static_cast<std::int64_t>(sample_debt) ;
+        sample_debt -= static_cast<double>(owed) ;
+    }
+    updateClock(std::chrono::steady_clock::now() + output_latency + std::chrono::nanoseconds((static_cast<std::int64_t>(padding) * 1000000000) / stream_rate)) ;
+    auto amount = loadStretched(data + (padding * SAMPLESIZE), frameCount - padding, owed) + padding ;
+    // Where we are in the file, however many samples the device asked for
+    auto samplesPerFrame = static_cast<double>(musicFile.sampleRate()) * std::chrono::duration<double>(frame_period).count() ;
+    current_frame = static_cast<int>(static_cast<double>(musicFile.position()) / samplesPerFrame) ;
     if (amount < frameCount) {
         return 1 ;
     }
@@ -237,8 +444,8 @@ auto MusicController::requestData(std::uint8_t *data,std::uint32_t frameCount, d
 //=============================================================
 auto MusicController::errorCallback(RtAudioErrorType type, const std::string &errorText) -> void {
     //DBGMSG(std::cout, "Error received on sound dac: "s + std::string(soundDac.getErrorText()));
-    if (soundDac.isStreamOpen()) {
-        soundDac.abortStream() ;
+    if (soundDac->isStreamOpen()) {
+        soundDac->abortStream() ;
     }
     if (musicErrorCallback != nullptr) {
         musicErrorCallback(this) ;
@@ -9,6 +9,9 @@
 #include <utility>
 #include <functional>
 #include <mutex>
+#include <chrono>
+#include <atomic>
+#include <memory>
 #include "rtaudio-6.0.1/RtAudio.h"
 #include "wavfile/mwavfile.hpp"
 #include "IOController.hpp"
@@ -17,7 +20,15 @@ using MusicPointer = MusicController* ;
 using MusicError = std::function<void(MusicPointer)> ;
 class MusicController: public IOController  {
     
-    RtAudio soundDac ;
+    static constexpr auto SAMPLESIZE = 4 ;    // 2 channels of 16 bit
+    // Anything faster than a few hundred ppm is heard, past it we step
+    static constexpr auto MAXSLEW = 0.0003 ;
+    // Made the first time it is needed (RtAudio opens the sound system), not
+    // when we are. Once made, it is there until we go
+    std::unique_ptr<RtAudio> soundDac ;
+    std::once_flag dac_once ;
+    std::atomic<bool> dac_made ;
+    auto dac() -> RtAudio& ;
     RtAudio::StreamParameters rtParameters ;
     
     MWAVFile musicFile ;
@@ -27,6 +38,35 @@ class MusicController: public IOController  {
     int my_device ;
     std::uint32_t bufferFrames ; // This we will use to setup our buffer size to match a frame period
     
+    // Set before the stream starts, only read in the callback after
+    bool prepared ;             // the stream is running, waiting for a commit
+    std::chrono::nanoseconds output_latency ;
+    std::uint32_t stream_rate ;
+    auto alignFirstBuffer(std::uint8_t *data, std::uint32_t frameCount) -> std::uint32_t ;
+    
+    // The playback clock (under frame_access): the file sample that is heard at
+    // clock_heard. Each callback measures it again, the error is filtered so the
+    // jitter of when callbacks run does not show, only the device's actual rate.
+    static constexpr auto CLOCKSTEP = std::chrono::milliseconds(5) ;
+    static constexpr auto CLOCKFILTER = 8 ;
+    bool clock_valid ;
+    std::uint32_t clock_sample ;
+    std::chrono::steady_clock::time_point clock_heard ;
+    auto updateClock(std::chrono::steady_clock::time_point heard) -> void ;
+    auto clockFrame(std::chrono::steady_clock::time_point at, double &frame) const -> bool ;
+    
+    // The sync loop's correction. There is no changing the device's rate, so
+    // when a whole sample is owed the buffer is read one sample short (or
+    // long) and stretched over the callback, rather than a sample repeated or
+    // dropped in one place
+    double rate_adjust ;
+    double sample_debt ;
+    std::vector<std::uint8_t> resample_buffer ;
+    auto loadStretched(std::uint8_t *data, std::uint32_t count, std::int64_t owed) -> std::uint32_t ;
+    auto framePosition(std::chrono::steady_clock::time_point now) const -> double final ;
+    auto userSetRate(double rate) -> void final ;
+    auto userStep(double sync_frame, double offset) -> void final ;
+    
     MusicError musicErrorCallback ;
     
     auto clearLoaded() -> void ;
@@ -47,9 +87,15 @@ class MusicController: public IOController  {
  
     auto load(const std::string &dataname) -> bool final ;
     auto stop() -> void final ;
-    auto start(std::int32_t frame = 0,int period = IOController::FRAMEPERIOD) -> bool final  ;
+    auto start(std::int32_t frame = 0,std::chrono::nanoseconds period = IOController::FRAMEPERIOD) -> bool final  ;
+    // prepare opens and starts the stream playing silence, commit says when the music begins
+    auto prepare(int frame, std::chrono::nanoseconds period = IOController::FRAMEPERIOD) -> bool final ;
+    auto commit(std::chrono::steady_clock::time_point at) -> bool final ;
     auto clear() -> void final ;
     
+    // The light frame (fractional) being heard at a time, false until the music is actually playing
+    auto audioFrame(std::chrono::steady_clock::time_point at, double &frame) const -> bool ;
+    
     // The callbacks we will use
     auto requestData(std::uint8_t *data,std::uint32_t frameCount, double time, RtAudioStreamFlags status ) -> int ;
     auto errorCallback(RtAudioErrorType type, const std::string &errorText) -> void ;
@@ -0,0 +1,223 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "NetworkOutput.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "utility/dbgutil.hpp"
+#include "utility/hashutil.hpp"
+
+using namespace std::string_literals ;
+
+namespace {
+    //======================================================================
+    auto put16(std::vector<std::uint8_t> &packet, std::size_t offset, std::uint16_t value) -> void {
+        packet[offset] = static_cast<std::uint8_t>(value >> 8) ;
+        packet[offset + 1] = static_cast<std::uint8_t>(value & 0xff) ;
+    }
+    
+    //======================================================================
+    auto put32(std::vector<std::uint8_t> &packet, std::size_t offset, std::uint32_t value) -> void {
+        put16(packet, offset, static_cast<std::uint16_t>(value >> 16)) ;
+        put16(packet, offset + 2, static_cast<std::uint16_t>(value & 0xffff)) ;
+    }
+}
+
+//======================================================================
+// ANSI E1.31 data packet, the root, framing and DMP layers ahead of the slots
+auto NetworkOutput::e131Packet(const UniverseConfig &config, const std::string &source, const std::array<std::uint8_t,16> &cid) -> std::vector<std::uint8_t> {
+    static const char identifier[12] = {'A','S','C','-','E','1','.','1','7',0,0,0} ;
+    auto size = static_cast<std::size_t>(E131SLOTOFFSET + config.length) ;
+    auto packet = std::vector<std::uint8_t>(size, 0) ;
+    // Root layer
+    put16(packet, 0, 0x0010) ;
+    put16(packet, 2, 0x0000) ;
+    std::copy(std::begin(identifier), std::end(identifier), packet.begin() + 4) ;
+    put16(packet, 16, static_cast<std::uint16_t>(0x7000 | (size - 16))) ;
+    put32(packet, 18, 0x00000004) ;
+    std::copy(cid.begin(), cid.end(), packet.begin() + 22) ;
+    // Framing layer
+    put16(packet, 38, static_cast<std::uint16_t>(0x7000 | (size - 38))) ;
+    put32(packet, 40, 0x00000002) ;
+    std::copy_n(source.begin(), std::min<std::size_t>(source.size(), 63), packet.begin() + 44) ;
+    packet[108] = E131PRIORITY ;
+    put16(packet, 109, 0) ;                 // no synchronization universe
+    packet[E131SEQUENCEOFFSET] = 0 ;
+    packet[112] = 0 ;                       // options
+    put16(packet, 113, static_cast<std::uint16_t>(config.universe)) ;
+    // DMP layer
+    put16(packet, 115, static_cast<std::uint16_t>(0x7000 | (size - 115))) ;
+    packet[117] = 0x02 ;
+    packet[118] = 0xa1 ;
+    put16(packet, 119, 0x0000) ;
+    put16(packet, 121, 0x0001) ;
+    put16(packet, 123, static_cast<std::uint16_t>(config.length + 1)) ;
+    packet[125] = 0 ;                       // DMX start code
+    return packet ;
+}
+
+//======================================================================
+// Art-Net ArtDmx. The data length has to be even
+auto NetworkOutput::artnetPacket(const UniverseConfig &config) -> std::vector<std::uint8_t> {
+    static const char identifier[8] = {'A','r','t','-','N','e','t',0} ;
+    auto slots = static_cast<std::size_t>(config.length + (config.length % 2)) ;
+    auto packet = std::vector<std::uint8_t>(ARTNETSLOTOFFSET + slots, 0) ;
+    std::copy(std::begin(identifier), std::end(identifier), packet.begin()) ;
+    packet[8] = 0x00 ;                      // OpDmx, little endian
+    packet[9] = 0x50 ;
+    put16(packet, 10, 14) ;                 // protocol version
+    packet[ARTNETSEQUENCEOFFSET] = 0 ;
+    packet[13] = 0 ;                        // physical
+    packet[14] = static_cast<std::uint8_t>(config.universe & 0xff) ;
+    packet[15] = static_cast<std::uint8_t>((config.universe >> 8) & 0x7f) ;
+    put16(packet, 16, static_cast<std::uint16_t>(slots)) ;
+    return packet ;
+}
+
+//======================================================================
+NetworkOutput::NetworkOutput():udpSocket(io_context) {
+    
+}
+
+//======================================================================
+NetworkOutput::~NetworkOutput() {
+    asio::error_code ec ;
+    udpSocket.close(ec) ;
+}
+
+//======================================================================
+auto NetworkOutput::configure(const std::vector<UniverseConfig> &configs, const std::string &source) -> bool {
+    auto lock = std::lock_guard(output_access) ;
+    universes.clear() ;
+#if defined(__linux__)
+    messages.clear() ;
+    vectors.clear() ;
+#endif
+    asio::error_code ec ;
+    udpSocket.close(ec) ;
+    if (configs.empty()) {
+        return true ;
+    }
+    udpSocket.open(asio::ip::udp::v4(), ec) ;
+    if (ec) {
+        DBGMSG(std::cerr, "Unable to open network output: "s + ec.message());
+        return false ;
+    }
+    udpSocket.set_option(asio::socket_base::broadcast(true), ec) ;
+    // A controller on this machine (or a test listener) should see multicast too
+    udpSocket.set_option(asio::ip::multicast::enable_loopback(true), ec) ;
+    
+    // The CID is a uuid for us as a source, stable for a given name
+    auto cid = std::array<std::uint8_t,16>() ;
+    auto first = util::ContentHash::hash(reinterpret_cast<const std::uint8_t*>(source.data()), source.size()) ;
+    auto second = util::ContentHash::hash(reinterpret_cast<const std::uint8_t*>(&first), sizeof(first)) ;
+    for (auto index = 0 ; index < 8 ; index++) {
+        cid[index] = static_cast<std::uint8_t>(first >> (index * 8)) ;
+        cid[index + 8] = static_cast<std::uint8_t>(second >> (index * 8)) ;
+    }
+    
+    for (const auto &config : configs) {
+        auto entry = Universe() ;
+        entry.config = config ;
+        entry.sequence = 0 ;
+        try {
+            if (config.protocol == UniverseConfig::E131) {
+                entry.packet = e131Packet(config, source, cid) ;
+                entry.slotOffset = E131SLOTOFFSET ;
+                entry.sequenceOffset = E131SEQUENCEOFFSET ;
+                // Without an address, the universe's multicast group 239.255.hi.lo
+                auto address = config.address.empty() ? asio::ip::make_address_v4(asio::ip::address_v4::uint_type(0xefff0000 | config.universe)) : asio::ip::make_address_v4(config.address) ;
+                entry.destination = asio::ip::udp::endpoint(address, E131PORT) ;
+            }
+            else {
+                entry.packet = artnetPacket(config) ;
+                entry.slotOffset = ARTNETSLOTOFFSET ;
+                entry.sequenceOffset = ARTNETSEQUENCEOFFSET ;
+                auto address = config.address.empty() ? asio::ip::address_v4::broadcast() : asio::ip::make_address_v4(config.address) ;
+                entry.destination = asio::ip::udp::endpoint(address, ARTNETPORT) ;
+            }
+        }
+        catch(...) {
+            DBGMSG(std::cerr, "Invalid address for universe "s + std::to_string(config.universe) + ": "s + config.address);
+            continue ;
+        }
+        universes.push_back(std::move(entry)) ;
+    }
+#if defined(__linux__)
+    // universes is not touched again until the next configure, so these can point into it
+    messages.resize(universes.size()) ;
+    vectors.resize(universes.size()) ;
+    for (auto index = std::size_t(0) ; index < universes.size() ; index++) {
+        vectors[index].iov_base = universes[index].packet.data() ;
+        vectors[index].iov_len = universes[index].packet.size() ;
+        std::memset(&messages[index], 0, sizeof(mmsghdr)) ;
+        messages[index].msg_hdr.msg_name = universes[index].destination.data() ;
+        messages[index].msg_hdr.msg_namelen = static_cast<socklen_t>(universes[index].destination.size()) ;
+        messages[index].msg_hdr.msg_iov = &vectors[index] ;
+        messages[index].msg_hdr.msg_iovlen = 1 ;
+    }
+#endif
+    return !universes.empty() ;
+}
+
+//======================================================================
+auto NetworkOutput::isActive() const -> bool {
+    auto lock = std::lock_guard(output_access) ;
+    return !universes.empty() ;
+}
+
+//======================================================================
+auto NetworkOutput::send(const std::uint8_t *data, int length) -> void {
+    auto lock = std::lock_guard(output_access) ;
+    if (universes.empty()) {
+        return ;
+    }
+    for (auto &entry : universes) {
+        auto slots = entry.packet.data() + entry.slotOffset ;
+        auto available = std::clamp(length - entry.config.inputOffset, 0, entry.config.length) ;
+        if (available > 0) {
+            std::memcpy(slots, data + entry.config.inputOffset, static_cast<std::size_t>(available)) ;
+        }
+        std::memset(slots + available, 0, entry.packet.size() - entry.slotOffset - static_cast<std::size_t>(available)) ;
+        entry.sequence += 1 ;
+        if (entry.config.protocol == UniverseConfig::ARTNET && entry.sequence == 0) {
+            // 0 tells an Art-Net node we do not sequence
+            entry.sequence = 1 ;
+        }
+        entry.packet[entry.sequenceOffset] = entry.sequence ;
+    }
+    transmit() ;
+}
+
+//======================================================================
+auto NetworkOutput::blackout() -> void {
+    this->send(nullptr, 0) ;
+}
+
+//======================================================================
+auto NetworkOutput::transmit() -> void {
+#if defined(__linux__)
+    auto handle = udpSocket.native_handle() ;
+    auto count = static_cast<unsigned int>(messages.size()) ;
+    auto sent = 0u ;
+    while (sent < count) {
+        auto result = ::sendmmsg(handle, messages.data() + sent, count - sent, 0) ;
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue ;
+            }
+            // Skip the one that failed (an unreachable controller), the rest should still go
+            sent += 1 ;
+            continue ;
+        }
+        sent += static_cast<unsigned int>(result) ;
+    }
+#else
+    for (auto &entry : universes) {
+        asio::error_code ec ;
+        udpSocket.send_to(asio::buffer(entry.packet), entry.destination, 0, ec) ;
+    }
+#endif
+}
@@ -0,0 +1,72 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef NetworkOutput_hpp
+#define NetworkOutput_hpp
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "asio.hpp"
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#endif
+
+#include "UniverseConfig.hpp"
+
+//======================================================================
+// Sends each light frame to pixel controllers as E1.31 (sACN) and/or Art-Net
+// universes. The packet for every universe is built once when configured, so a
+// frame only copies in the DMX slots and bumps the sequence number, and on
+// Linux all of a frame's universes go out in one sendmmsg.
+class NetworkOutput {
+public:
+    static constexpr std::uint16_t E131PORT = 5568 ;
+    static constexpr std::uint16_t ARTNETPORT = 6454 ;
+    static constexpr auto E131SLOTOFFSET = 126 ;
+    static constexpr auto E131SEQUENCEOFFSET = 111 ;
+    static constexpr auto ARTNETSLOTOFFSET = 18 ;
+    static constexpr auto ARTNETSEQUENCEOFFSET = 12 ;
+    static constexpr std::uint8_t E131PRIORITY = 100 ;
+    
+private:
+    struct Universe {
+        UniverseConfig config ;
+        std::vector<std::uint8_t> packet ;
+        std::size_t slotOffset ;
+        std::size_t sequenceOffset ;
+        std::uint8_t sequence ;
+        asio::ip::udp::endpoint destination ;
+    };
+    
+    mutable std::mutex output_access ;
+    asio::io_context io_context ;
+    asio::ip::udp::socket udpSocket ;
+    std::vector<Universe> universes ;
+#if defined(__linux__)
+    std::vector<mmsghdr> messages ;
+    std::vector<iovec> vectors ;
+#endif
+    
+    static auto e131Packet(const UniverseConfig &config, const std::string &source, const std::array<std::uint8_t,16> &cid) -> std::vector<std::uint8_t> ;
+    static auto artnetPacket(const UniverseConfig &config) -> std::vector<std::uint8_t> ;
+    auto transmit() -> void ;
+    
+public:
+    NetworkOutput() ;
+    ~NetworkOutput() ;
+    
+    // Replaces the universes (an empty list turns us off). The source name identifies us to E1.31 receivers
+    auto configure(const std::vector<UniverseConfig> &configs, const std::string &source) -> bool ;
+    auto isActive() const -> bool ;
+    
+    // Slice a frame into the universes and send them. Slots past the end of the frame are 0
+    auto send(const std::uint8_t *data, int length) -> void ;
+    // Every slot 0
+    auto blackout() -> void ;
+};
+
+#endif /* NetworkOutput_hpp */
@@ -0,0 +1,189 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "RelayPeer.hpp"
+
+#include <algorithm>
+
+#include "utility/dbgutil.hpp"
+
+using namespace std::string_literals ;
+
+//======================================================================
+RelayPeer::RelayPeer(asio::ip::tcp::socket socket, std::size_t limit):peerSocket(std::move(socket)),receiveNeeded(0),queued(0),frontOffset(0),queueLimit(limit),writing(false),closed(false),processingCallback(nullptr),closeCallback(nullptr) {
+    asio::error_code ec ;
+    auto endpoint = peerSocket.remote_endpoint(ec) ;
+    if (!ec) {
+        peerAddress = endpoint.address().to_string() + ":"s + std::to_string(endpoint.port()) ;
+    }
+    // Small packets (SYNC) should not wait on Nagle, and sends are tried right away
+    peerSocket.set_option(asio::ip::tcp::no_delay(true), ec) ;
+    peerSocket.non_blocking(true, ec) ;
+    gather.reserve(MAXGATHER) ;
+}
+
+//======================================================================
+auto RelayPeer::start() -> void {
+    asio::co_spawn(peerSocket.get_executor(), this->readLoop(), asio::detached) ;
+}
+
+//======================================================================
+auto RelayPeer::close() -> void {
+    if (closed) {
+        return ;
+    }
+    closed = true ;
+    asio::error_code ec ;
+    peerSocket.shutdown(asio::ip::tcp::socket::shutdown_both, ec) ;
+    peerSocket.close(ec) ;
+    queue.clear() ;
+    queued = 0 ;
+    frontOffset = 0 ;
+    if (closeCallback != nullptr) {
+        closeCallback(this->shared_from_this()) ;
+    }
+}
+
+//======================================================================
+auto RelayPeer::is_open() const -> bool {
+    return !closed && peerSocket.is_open() ;
+}
+
+//======================================================================
+auto RelayPeer::readLoop() -> asio::awaitable<void> {
+    auto self = this->shared_from_this() ;
+    while (this->is_open()) {
+        asio::error_code ec ;
+        auto bytes_transferred = co_await peerSocket.async_read_some(receiveBuffer.prepare(receiveNeeded), asio::redirect_error(asio::use_awaitable, ec)) ;
+        if (ec) {
+            this->close() ;
+            co_return ;
+        }
+        if (!this->process(bytes_transferred)) {
+            this->close() ;
+            co_return ;
+        }
+    }
+}
+
+//======================================================================
+auto RelayPeer::process(std::size_t bytes_transferred) -> bool {
+    receiveBuffer.commit(bytes_transferred) ;
+    receiveNeeded = 0 ;
+    while (receiveBuffer.available() >= static_cast<std::size_t>(Packet::PACKETHEADERSIZE)) {
+        auto length = Packet::lengthFromHeader(receiveBuffer.data()) ;
+        if (length < static_cast<std::uint32_t>(Packet::PACKETHEADERSIZE) || length > MAXPACKETLENGTH) {
+            DBGMSG(std::cerr, "Invalid packet length: "s + std::to_string(length) + " from relay peer "s + peerAddress);
+            return false ;
+        }
+        if (receiveBuffer.available() < length) {
+            receiveNeeded = length - receiveBuffer.available() ;
+            break ;
+        }
+        auto packet = std::make_shared<Packet>(std::vector<std::uint8_t>(receiveBuffer.data(),receiveBuffer.data() + length)) ;
+        packet->stamp() ;
+        receiveBuffer.consume(length) ;
+        if (processingCallback != nullptr) {
+            processingCallback(this->shared_from_this(), packet) ;
+        }
+        if (!this->is_open()) {
+            return false ;
+        }
+    }
+    return true ;
+}
+
+//======================================================================
+auto RelayPeer::send(PacketPointer packet) -> bool {
+    if (!this->is_open()) {
+        return false ;
+    }
+    if (queued + packet->size() > queueLimit) {
+        return false ;
+    }
+    auto offset = std::size_t(0) ;
+    if (!writing) {
+        // Nothing ahead of it, so try it straight away, most of the time the socket takes it all
+        asio::error_code ec ;
+        offset = peerSocket.write_some(asio::buffer(packet->data.data(), packet->size()), ec) ;
+        if (ec && ec != asio::error::would_block && ec != asio::error::try_again) {
+            return false ;
+        }
+        if (offset == packet->size()) {
+            return true ;
+        }
+    }
+    queue.push_back(packet) ;
+    queued += packet->size() - offset ;
+    if (queue.size() == 1) {
+        frontOffset = offset ;
+    }
+    if (!writing) {
+        writing = true ;
+        asio::co_spawn(peerSocket.get_executor(), this->writeLoop(), asio::detached) ;
+    }
+    return true ;
+}
+
+//======================================================================
+auto RelayPeer::send(const Packet &packet) -> bool {
+    return this->send(std::make_shared<Packet>(packet.data)) ;
+}
+
+//======================================================================
+auto RelayPeer::writeLoop() -> asio::awaitable<void> {
+    auto self = this->shared_from_this() ;
+    while (this->is_open() && !queue.empty()) {
+        // Everything waiting (up to a limit) goes out in one gathered write
+        auto count = std::min<std::size_t>(queue.size(), MAXGATHER) ;
+        gather.clear() ;
+        for (auto index = std::size_t(0) ; index < count ; index++) {
+            gather.push_back(asio::buffer(queue[index]->data.data(), queue[index]->size()) + (index == 0 ? frontOffset : 0)) ;
+        }
+        asio::error_code ec ;
+        co_await asio::async_write(peerSocket, gather, asio::redirect_error(asio::use_awaitable, ec)) ;
+        if (ec) {
+            writing = false ;
+            this->close() ;
+            co_return ;
+        }
+        if (closed) {
+            break ;
+        }
+        for (auto index = std::size_t(0) ; index < count ; index++) {
+            queued -= queue.front()->size() - frontOffset ;
+            frontOffset = 0 ;
+            queue.pop_front() ;
+        }
+    }
+    writing = false ;
+}
+
+//======================================================================
+auto RelayPeer::setPacketRoutine(PacketProcessing function) -> void {
+    processingCallback = function ;
+}
+
+//======================================================================
+auto RelayPeer::setCloseCallback(CloseCallback function) -> void {
+    closeCallback = function ;
+}
+
+//======================================================================
+auto RelayPeer::setName(const std::string &name) -> void {
+    peerName = name ;
+}
+
+//======================================================================
+auto RelayPeer::name() const -> const std::string& {
+    return peerName ;
+}
+
+//======================================================================
+auto RelayPeer::peer() const -> const std::string& {
+    return peerAddress ;
+}
+
+//======================================================================
+auto RelayPeer::backlog() const -> std::size_t {
+    return queued ;
+}
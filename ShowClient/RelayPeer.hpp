@@ -0,0 +1,78 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef RelayPeer_hpp
+#define RelayPeer_hpp
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "asio.hpp"
+
+#include "network/ReceiveBuffer.hpp"
+#include "packets/Packet.hpp"
+
+class RelayPeer ;
+using RelayPeerPointer = std::shared_ptr<RelayPeer> ;
+using PacketPointer = std::shared_ptr<Packet> ;
+
+//======================================================================
+// A downstream client connected to our relay. It is sent the very packets we
+// got from the server (the queue holds the shared packets, nothing is copied
+// or rebuilt per peer), and has its own write loop, so a peer that falls behind
+// only backs up its own queue. Only used from the client's context.
+class RelayPeer : public std::enable_shared_from_this<RelayPeer> {
+public:
+    using PacketProcessing = std::function<void(RelayPeerPointer,PacketPointer)> ;
+    using CloseCallback = std::function<void(RelayPeerPointer)> ;
+    static constexpr std::uint32_t MAXPACKETLENGTH = 256 * 1024 ;
+    // How many queued packets go out in one (gathered) write
+    static constexpr auto MAXGATHER = 64 ;
+    
+private:
+    asio::ip::tcp::socket peerSocket ;
+    std::string peerName ;
+    std::string peerAddress ;
+    
+    ReceiveBuffer receiveBuffer ;
+    std::size_t receiveNeeded ;
+    
+    std::deque<PacketPointer> queue ;
+    std::vector<asio::const_buffer> gather ;
+    std::size_t queued ;
+    std::size_t frontOffset ;   // how much of the first queued packet already went out
+    std::size_t queueLimit ;
+    bool writing ;
+    bool closed ;
+    
+    PacketProcessing processingCallback ;
+    CloseCallback closeCallback ;
+    
+    auto readLoop() -> asio::awaitable<void> ;
+    auto writeLoop() -> asio::awaitable<void> ;
+    auto process(std::size_t bytes_transferred) -> bool ;
+    
+public:
+    RelayPeer(asio::ip::tcp::socket socket, std::size_t limit) ;
+    
+    auto start() -> void ;
+    auto close() -> void ;
+    auto is_open() const -> bool ;
+    
+    // Queue a packet, false (and nothing queued) if that would put us over our limit
+    auto send(PacketPointer packet) -> bool ;
+    // A packet only this peer gets (a reply)
+    auto send(const Packet &packet) -> bool ;
+    
+    auto setPacketRoutine(PacketProcessing function) -> void ;
+    auto setCloseCallback(CloseCallback function) -> void ;
+    auto setName(const std::string &name) -> void ;
+    auto name() const -> const std::string& ;
+    auto peer() const -> const std::string& ;
+    auto backlog() const -> std::size_t ;
+};
+
+#endif /* RelayPeer_hpp */
@@ -0,0 +1,181 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "RelayServer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+
+#include "utility/dbgutil.hpp"
+
+using namespace std::string_literals ;
+
+//======================================================================
+RelayServer::RelayServer():context(nullptr),queueLimit(DEFAULTQUEUE),listenPort(0),forwardCount(0),slowCount(0),peerRoutine(nullptr) {
+    
+}
+
+//======================================================================
+auto RelayServer::start(asio::io_context &io_context, std::uint16_t port) -> void {
+    context = &io_context ;
+    asio::post(io_context,[this,port](){
+        if (port == listenPort && (port == 0 || acceptor != nullptr)) {
+            return ;
+        }
+        this->listen(port) ;
+    });
+}
+
+//======================================================================
+auto RelayServer::listen(std::uint16_t port) -> void {
+    if (acceptor != nullptr) {
+        asio::error_code ec ;
+        acceptor->close(ec) ;
+        acceptor = nullptr ;
+    }
+    this->disconnectPeers() ;
+    listenPort = port ;
+    if (port == 0) {
+        return ;
+    }
+    try {
+        acceptor = std::make_unique<asio::ip::tcp::acceptor>(*context) ;
+        auto endpoint = asio::ip::tcp::endpoint(asio::ip::address_v4::any(),port) ;
+        acceptor->open(endpoint.protocol()) ;
+        acceptor->set_option(asio::socket_base::reuse_address(true)) ;
+        acceptor->bind(endpoint) ;
+        acceptor->listen() ;
+    }
+    catch(const std::exception &e) {
+        DBGMSG(std::cerr, "Unable to relay on port "s + std::to_string(port) + ": "s + e.what());
+        acceptor = nullptr ;
+        return ;
+    }
+    asio::co_spawn(*context, this->acceptLoop(), asio::detached) ;
+}
+
+//======================================================================
+auto RelayServer::acceptLoop() -> asio::awaitable<void> {
+    while (acceptor != nullptr && acceptor->is_open()) {
+        asio::error_code ec ;
+        auto socket = co_await acceptor->async_accept(asio::redirect_error(asio::use_awaitable, ec)) ;
+        if (ec) {
+            if (ec == asio::error::operation_aborted) {
+                co_return ;
+            }
+            continue ;
+        }
+        auto peer = std::make_shared<RelayPeer>(std::move(socket), queueLimit) ;
+        peer->setPacketRoutine(peerRoutine) ;
+        peer->setCloseCallback(std::bind(&RelayServer::peerClosed,this,std::placeholders::_1)) ;
+        peers.push_back(peer) ;
+        DBGMSG(std::cout, "Relay peer connected: "s + peer->peer() + " ("s + std::to_string(peers.size()) + " peers)"s);
+        peer->start() ;
+    }
+}
+
+//======================================================================
+auto RelayServer::peerClosed(RelayPeerPointer peer) -> void {
+    auto iter = std::find(peers.begin(),peers.end(),peer) ;
+    if (iter != peers.end()) {
+        peers.erase(iter) ;
+        DBGMSG(std::cout, "Relay peer disconnected: "s + peer->peer() + " "s + peer->name());
+    }
+}
+
+//======================================================================
+auto RelayServer::stop() -> void {
+    if (context == nullptr) {
+        return ;
+    }
+    if (context->get_executor().running_in_this_thread()) {
+        this->listen(0) ;
+        return ;
+    }
+    // Wait for it, the context may be going away after this
+    auto done = std::make_shared<std::promise<void>>() ;
+    auto finished = done->get_future() ;
+    asio::post(*context,[this,done](){
+        this->listen(0) ;
+        done->set_value() ;
+    });
+    finished.wait_for(std::chrono::seconds(1)) ;
+}
+
+//======================================================================
+auto RelayServer::setQueueLimit(std::size_t bytes) -> void {
+    if (context == nullptr) {
+        queueLimit = bytes ;
+        return ;
+    }
+    asio::post(*context,[this,bytes](){
+        queueLimit = bytes ;
+    });
+}
+
+//======================================================================
+auto RelayServer::setPeerRoutine(RelayPeer::PacketProcessing function) -> void {
+    peerRoutine = function ;
+}
+
+//======================================================================
+auto RelayServer::forward(PacketPointer packet) -> void {
+    if (peers.empty()) {
+        return ;
+    }
+    switch (packet->packetID()) {
+        case PacketType::SYNC:
+        case PacketType::LOAD:
+        case PacketType::SHOW:
+        case PacketType::PLAY:
+        case PacketType::BUFFER:
+        case PacketType::ZBUFFER:
+        case PacketType::SCENE:
+            break ;
+        default:
+            // Probes, content and the like are between us and the server
+            return ;
+    }
+    forwardCount += 1 ;
+    for (auto &peer : peers) {
+        if (!peer->send(packet)) {
+            slow.push_back(peer) ;
+        }
+    }
+    // Closing a peer takes it out of peers, so that waits until we are through them
+    for (auto &peer : slow) {
+        slowCount += 1 ;
+        DBGMSG(std::cerr, "Dropping relay peer "s + peer->peer() + ", "s + std::to_string(peer->backlog()) + " bytes behind"s);
+        peer->close() ;
+    }
+    slow.clear() ;
+}
+
+//======================================================================
+auto RelayServer::disconnectPeers() -> void {
+    auto current = peers ;
+    for (auto &peer : current) {
+        peer->close() ;
+    }
+    peers.clear() ;
+}
+
+//======================================================================
+auto RelayServer::port() const -> std::uint16_t {
+    return listenPort ;
+}
+
+//======================================================================
+auto RelayServer::peerCount() const -> std::size_t {
+    return peers.size() ;
+}
+
+//======================================================================
+auto RelayServer::forwarded() const -> std::uint64_t {
+    return forwardCount ;
+}
+
+//======================================================================
+auto RelayServer::slowPeers() const -> std::uint64_t {
+    return slowCount ;
+}
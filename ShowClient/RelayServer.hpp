@@ -0,0 +1,69 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef RelayServer_hpp
+#define RelayServer_hpp
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "asio.hpp"
+
+#include "packets/Packet.hpp"
+
+#include "RelayPeer.hpp"
+
+//======================================================================
+// Lets nearby clients connect to us, instead of each holding a connection to
+// the server, and passes them the show stream (SYNC, LOAD, SHOW, PLAY and the
+// light buffers) as we get it. Each packet is handed to every peer's queue as
+// is. A peer whose queue goes past the limit is dropped, rather than holding
+// back the others or growing without bound. Everything runs on the client's
+// context.
+class RelayServer {
+public:
+    static constexpr std::size_t DEFAULTQUEUE = 1024 * 1024 ;
+    
+private:
+    asio::io_context *context ;
+    std::unique_ptr<asio::ip::tcp::acceptor> acceptor ;
+    std::vector<RelayPeerPointer> peers ;
+    std::vector<RelayPeerPointer> slow ;
+    std::size_t queueLimit ;
+    std::uint16_t listenPort ;
+    
+    std::uint64_t forwardCount ;
+    std::uint64_t slowCount ;
+    
+    RelayPeer::PacketProcessing peerRoutine ;
+    
+    auto acceptLoop() -> asio::awaitable<void> ;
+    auto peerClosed(RelayPeerPointer peer) -> void ;
+    auto listen(std::uint16_t port) -> void ;
+    
+public:
+    RelayServer() ;
+    
+    // The port peers connect on, 0 stops relaying. Can be called from any thread
+    auto start(asio::io_context &io_context, std::uint16_t port) -> void ;
+    // Not from the client's context, this waits for it to close everything
+    auto stop() -> void ;
+    // Bytes a peer can have waiting before we drop it
+    auto setQueueLimit(std::size_t bytes) -> void ;
+    // What peers send us (probes, scene misses)
+    auto setPeerRoutine(RelayPeer::PacketProcessing function) -> void ;
+    
+    // Pass a packet from the server on to the peers, if it is part of the show stream
+    auto forward(PacketPointer packet) -> void ;
+    // Drop the peers (we lost the server), they will reconnect
+    auto disconnectPeers() -> void ;
+    
+    auto port() const -> std::uint16_t ;
+    auto peerCount() const -> std::size_t ;
+    auto forwarded() const -> std::uint64_t ;
+    auto slowPeers() const -> std::uint64_t ;
+};
+
+#endif /* RelayServer_hpp */
@@ -0,0 +1,92 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "SceneCache.hpp"
+
+#include <algorithm>
+
+#include "utility/hashutil.hpp"
+
+using namespace std::string_literals ;
+
+//======================================================================
+SceneCache::SceneCache(size_t budget):budget(budget),used(0),hitCount(0),missCount(0),evictCount(0) {
+    
+}
+
+//======================================================================
+auto SceneCache::trim() -> void {
+    while (used > budget && !scenes.empty()) {
+        used -= scenes.back().second.size() ;
+        index.erase(scenes.back().first) ;
+        scenes.pop_back() ;
+        evictCount += 1 ;
+    }
+}
+
+//======================================================================
+auto SceneCache::setBudget(size_t bytes) -> void {
+    budget = bytes ;
+    trim() ;
+}
+
+//======================================================================
+auto SceneCache::clear() -> void {
+    scenes.clear() ;
+    index.clear() ;
+    used = 0 ;
+}
+
+//======================================================================
+auto SceneCache::store(const std::vector<std::uint8_t> &data) -> std::uint64_t {
+    auto hash = util::ContentHash::hash(data.data(), data.size()) ;
+    auto iter = index.find(hash) ;
+    if (iter != index.end()) {
+        scenes.splice(scenes.begin(), scenes, iter->second) ;
+        return hash ;
+    }
+    if (data.empty() || data.size() > budget) {
+        return hash ;
+    }
+    scenes.emplace_front(hash, data) ;
+    index.insert_or_assign(hash, scenes.begin()) ;
+    used += data.size() ;
+    trim() ;
+    return hash ;
+}
+
+//======================================================================
+auto SceneCache::find(std::uint64_t hash) -> const std::vector<std::uint8_t>* {
+    auto iter = index.find(hash) ;
+    if (iter == index.end()) {
+        missCount += 1 ;
+        return nullptr ;
+    }
+    hitCount += 1 ;
+    scenes.splice(scenes.begin(), scenes, iter->second) ;
+    return &scenes.front().second ;
+}
+
+//======================================================================
+auto SceneCache::size() const -> size_t {
+    return scenes.size() ;
+}
+
+//======================================================================
+auto SceneCache::bytes() const -> size_t {
+    return used ;
+}
+
+//======================================================================
+auto SceneCache::hits() const -> std::uint64_t {
+    return hitCount ;
+}
+
+//======================================================================
+auto SceneCache::misses() const -> std::uint64_t {
+    return missCount ;
+}
+
+//======================================================================
+auto SceneCache::evictions() const -> std::uint64_t {
+    return evictCount ;
+}
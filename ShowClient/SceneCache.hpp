@@ -0,0 +1,50 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef SceneCache_hpp
+#define SceneCache_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//======================================================================
+// The light buffers we have been sent, least recently used first out once
+// they no longer fit in the budget. Only used from the client's context.
+class SceneCache {
+    using Scene = std::pair<std::uint64_t,std::vector<std::uint8_t>> ;
+    std::list<Scene> scenes ;     // most recently used at the front
+    std::unordered_map<std::uint64_t,std::list<Scene>::iterator> index ;
+    size_t budget ;
+    size_t used ;
+    std::uint64_t hitCount ;
+    std::uint64_t missCount ;
+    std::uint64_t evictCount ;
+    
+    auto trim() -> void ;
+    
+public:
+    static constexpr size_t DEFAULTBUDGET = 1024 * 1024 ;
+    
+    SceneCache(size_t budget = DEFAULTBUDGET) ;
+    
+    // Bytes of buffer data we keep (0 keeps nothing)
+    auto setBudget(size_t bytes) -> void ;
+    auto clear() -> void ;
+    
+    // Keep a buffer, returns its hash
+    auto store(const std::vector<std::uint8_t> &data) -> std::uint64_t ;
+    // The buffer for a hash, or nullptr. Good until the next store.
+    auto find(std::uint64_t hash) -> const std::vector<std::uint8_t>* ;
+    
+    auto size() const -> size_t ;
+    auto bytes() const -> size_t ;
+    auto hits() const -> std::uint64_t ;
+    auto misses() const -> std::uint64_t ;
+    auto evictions() const -> std::uint64_t ;
+};
+
+#endif /* SceneCache_hpp */
@@ -0,0 +1,86 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "StartupTrace.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "utility/dbgutil.hpp"
+
+using namespace std::string_literals ;
+
+//======================================================================
+StartupTrace::StartupTrace():origin(std::chrono::steady_clock::now()),bootOffset(0),reported(false) {
+#if defined(__linux__)
+    // Field 22 of /proc/self/stat is when we started, in ticks since boot. The
+    // name (field 2) can have spaces, so count from its closing paren
+    auto input = std::ifstream("/proc/self/stat") ;
+    auto line = std::string() ;
+    auto uptime = timespec{} ;
+    if (std::getline(input, line) && ::clock_gettime(CLOCK_BOOTTIME, &uptime) == 0) {
+        auto close = line.rfind(')') ;
+        if (close != std::string::npos) {
+            auto fields = std::istringstream(line.substr(close + 1)) ;
+            auto field = std::string() ;
+            // The state is field 3, the start time field 22
+            for (auto index = 3 ; index <= 22 && fields >> field ; index++) {
+            }
+            auto ticks = std::strtoull(field.c_str(), nullptr, 10) ;
+            auto rate = ::sysconf(_SC_CLK_TCK) ;
+            if (ticks > 0 && rate > 0) {
+                auto started = std::chrono::milliseconds((static_cast<std::int64_t>(ticks) * 1000) / rate) ;
+                auto now = std::chrono::milliseconds((static_cast<std::int64_t>(uptime.tv_sec) * 1000) + (uptime.tv_nsec / 1000000)) ;
+                if (now >= started) {
+                    bootOffset = started ;
+                    origin -= (now - started) ;
+                }
+            }
+        }
+    }
+#endif
+}
+
+//======================================================================
+auto StartupTrace::instance() -> StartupTrace& {
+    static StartupTrace trace ;
+    return trace ;
+}
+
+//======================================================================
+auto StartupTrace::mark(const std::string &phase) -> void {
+    auto now = std::chrono::steady_clock::now() ;
+    auto lock = std::lock_guard(access) ;
+    if (!reported) {
+        phases.push_back(std::make_pair(phase, now)) ;
+    }
+}
+
+//======================================================================
+auto StartupTrace::finish(const std::string &phase) -> void {
+    auto now = std::chrono::steady_clock::now() ;
+    auto lock = std::lock_guard(access) ;
+    if (reported) {
+        return ;
+    }
+    reported = true ;
+    phases.push_back(std::make_pair(phase, now)) ;
+    std::stable_sort(phases.begin(), phases.end(), [](const auto &first, const auto &second) {
+        return first.second < second.second ;
+    });
+    auto text = std::string() ;
+    for (const auto &[name,when] : phases) {
+        text += (text.empty() ? ""s : ", "s) + name + " "s + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(when - origin).count()) + " ms"s ;
+    }
+    if (bootOffset.count() > 0) {
+        text += " (started "s + std::to_string(bootOffset.count()) + " ms after boot)"s ;
+    }
+    DBGMSG(std::cout, "Startup: "s + text);
+    phases.clear() ;
+}
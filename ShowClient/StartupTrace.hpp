@@ -0,0 +1,38 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef StartupTrace_hpp
+#define StartupTrace_hpp
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+//======================================================================
+// When each part of starting up finished, from when the process was started
+// (the kernel's start time, so loading and static construction count) to the
+// first connect to the server. Phases can be marked from any thread; the
+// first connect reports them, in the order they finished, and later marks are
+// ignored.
+class StartupTrace {
+    std::mutex access ;
+    // Where the process start is, on the steady clock
+    std::chrono::steady_clock::time_point origin ;
+    // How long the machine had been up when the process started (zero if unknown)
+    std::chrono::milliseconds bootOffset ;
+    std::vector<std::pair<std::string,std::chrono::steady_clock::time_point>> phases ;
+    bool reported ;
+
+    StartupTrace() ;
+public:
+    static auto instance() -> StartupTrace& ;
+    StartupTrace(const StartupTrace&) = delete ;
+    auto operator=(const StartupTrace&) -> StartupTrace& = delete ;
+
+    auto mark(const std::string &phase) -> void ;
+    // Marks it, and logs them all. Only the first time
+    auto finish(const std::string &phase) -> void ;
+};
+
+#endif /* StartupTrace_hpp */
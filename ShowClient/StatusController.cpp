@@ -5,64 +5,124 @@
 #include "utility/dbgutil.hpp"
 using namespace std::string_literals;
 // ==================================================================
-StatusController::StatusController() {
-    leds.push_back(BeagleLed(static_cast<int>(StatusLed::RUN),"Run status"));
-    leds.push_back(BeagleLed(static_cast<int>(StatusLed::CONNECT),"Connect status"));
-    leds.push_back(BeagleLed(static_cast<int>(StatusLed::SHOW),"Show status"));
-    leds.push_back(BeagleLed(static_cast<int>(StatusLed::PLAY),"Play status"));
+StatusController::StatusController():writing(false),running(true) {
+    leds.push_back(std::make_unique<BeagleLed>(static_cast<int>(StatusLed::RUN),"Run status"));
+    leds.push_back(std::make_unique<BeagleLed>(static_cast<int>(StatusLed::CONNECT),"Connect status"));
+    leds.push_back(std::make_unique<BeagleLed>(static_cast<int>(StatusLed::SHOW),"Show status"));
+    leds.push_back(std::make_unique<BeagleLed>(static_cast<int>(StatusLed::PLAY),"Play status"));
+    for (auto entry = std::size_t(0) ; entry < LEDCOUNT ; entry++) {
+        wanted[entry] = leds[entry]->state() ;
+        pending[entry] = false ;
+        forced[entry] = false ;
+    }
 }
 
-
 // ==================================================================
-auto StatusController::operator[](StatusLed led) const -> const BeagleLed& {
-    auto iter = std::find_if(leds.begin(),leds.end(),[led](const BeagleLed &entry){
-        return entry.number() == static_cast<int>(led) ;
-    });
-    if (iter == leds.end()) {
-        throw std::runtime_error("Invalid status led was requested: "s + std::to_string(static_cast<int>(led)));
+StatusController::~StatusController() {
+    {
+        auto lock = std::lock_guard(access) ;
+        running = false ;
+    }
+    wakeup.notify_all() ;
+    if (writer.joinable()) {
+        writer.join() ;
     }
-    return *iter ;
 }
 
 // ==================================================================
-auto StatusController::operator[](StatusLed led) -> BeagleLed& {
-    auto iter = std::find_if(leds.begin(),leds.end(),[led](const BeagleLed &entry){
-        return entry.number() == static_cast<int>(led) ;
+auto StatusController::index(StatusLed led) const -> std::size_t {
+    auto iter = std::find_if(leds.begin(),leds.end(),[led](const std::unique_ptr<BeagleLed> &entry){
+        return entry->number() == static_cast<int>(led) ;
     });
     if (iter == leds.end()) {
         throw std::runtime_error("Invalid status led was requested: "s + std::to_string(static_cast<int>(led)));
     }
-    return *iter ;
+    return static_cast<std::size_t>(std::distance(leds.begin(),iter)) ;
+}
 
+// ==================================================================
+auto StatusController::operator[](StatusLed led) const -> const BeagleLed& {
+    return *leds[index(led)] ;
 }
 
 // ==================================================================
 auto StatusController::clear() -> void {
     for (auto &entry:leds) {
-
-        entry.setState(LedState::OFF,true);
+        setState(static_cast<StatusLed>(entry->number()), LedState::OFF, true);
     }
 }
 
 // ==================================================================
 auto StatusController::flash() -> void {
     for (auto &entry:leds) {
-        entry.setState(LedState::FLASH,true);
+        setState(static_cast<StatusLed>(entry->number()), LedState::FLASH, true);
     }
 }
 
 // ==================================================================
 auto StatusController::describe(StatusLed led) const -> std::string {
-    auto iter = std::find_if(leds.begin(),leds.end(),[led](const BeagleLed &entry){
-        return entry.number() == static_cast<int>(led) ;
-    });
-    if (iter == leds.end()) {
-        throw std::runtime_error("Invalid status led was requested: "s + std::to_string(static_cast<int>(led)));
-    }
-    return iter->describe();
+    return leds[index(led)]->describe();
 }
 
 // ==================================================================
 auto StatusController::setState(StatusLed led, LedState state,bool force) -> void {
-    this->operator[](led).setState(state,force);
+    auto entry = index(led) ;
+    {
+        auto lock = std::lock_guard(access) ;
+        if (state == wanted[entry] && !force) {
+            // Already what it is (or is going to be)
+            return ;
+        }
+        wanted[entry] = state ;
+        pending[entry] = true ;
+        forced[entry] = forced[entry] || force ;
+        if (!writer.joinable()) {
+            writer = std::thread(&StatusController::runWriter,this) ;
+        }
+    }
+    wakeup.notify_one() ;
+}
+
+// ==================================================================
+auto StatusController::state(StatusLed led) -> LedState {
+    auto entry = index(led) ;
+    auto lock = std::lock_guard(access) ;
+    return wanted[entry] ;
+}
+
+// ==================================================================
+auto StatusController::flush() -> void {
+    auto lock = std::unique_lock(access) ;
+    written.wait(lock,[this]{
+        return !writing && std::none_of(pending.begin(), pending.end(), [](bool value){ return value ; }) ;
+    });
+}
+
+// ==================================================================
+auto StatusController::runWriter() -> void {
+    auto lock = std::unique_lock(access) ;
+    while (true) {
+        wakeup.wait(lock,[this]{
+            return !running || std::any_of(pending.begin(), pending.end(), [](bool value){ return value ; }) ;
+        });
+        auto states = wanted ;
+        auto which = pending ;
+        auto force = forced ;
+        if (std::none_of(which.begin(), which.end(), [](bool value){ return value ; })) {
+            // Stopping, with nothing left to write
+            break ;
+        }
+        pending.fill(false) ;
+        forced.fill(false) ;
+        writing = true ;
+        lock.unlock() ;
+        for (auto entry = std::size_t(0) ; entry < LEDCOUNT ; entry++) {
+            if (which[entry]) {
+                leds[entry]->setState(states[entry], force[entry]) ;
+            }
+        }
+        lock.lock() ;
+        writing = false ;
+        written.notify_all() ;
+    }
 }
@@ -3,7 +3,12 @@
 #ifndef StatusController_hpp
 #define StatusController_hpp
 
+#include <array>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "bone/BeagleLed.hpp"
@@ -11,18 +16,46 @@ enum class StatusLed{
     RUN=0,CONNECT,SHOW,PLAY
 };
 
+// The status leds are written by a thread of their own (started with the
+// first change), so setState never waits on sysfs. It only records what a
+// led should be; the writer takes the latest of each, so a led changed
+// several times before it gets there is written once, and a change back to
+// what it already was is not written at all.
 class StatusController {
-    std::vector<BeagleLed> leds ;
-    
+    static constexpr auto LEDCOUNT = 4 ;
+
+    // Only the writer touches them, once it is going
+    std::vector<std::unique_ptr<BeagleLed>> leds ;
+
+    std::mutex access ;
+    std::condition_variable wakeup ;
+    std::condition_variable written ;
+    std::array<LedState,LEDCOUNT> wanted ;
+    std::array<bool,LEDCOUNT> pending ;
+    std::array<bool,LEDCOUNT> forced ;
+    bool writing ;
+    bool running ;
+    std::thread writer ;
+
+    auto index(StatusLed led) const -> std::size_t ;
+    auto runWriter() -> void ;
+
 public:
     StatusController() ;
+    // Writes what is still pending before it goes
+    ~StatusController() ;
+
+    // What the writer last wrote, after a flush it is everything asked for
     auto operator[](StatusLed led) const -> const BeagleLed& ;
-    auto operator[](StatusLed led) -> BeagleLed& ;
-    
+
     auto clear() -> void ;
     auto flash() -> void ;
     auto describe(StatusLed led) const -> std::string ;
     auto setState(StatusLed led, LedState state,bool force = false ) -> void ;
+    // What it was last asked to be
+    auto state(StatusLed led) -> LedState ;
+    // Waits for the writer to get everything asked for so far
+    auto flush() -> void ;
 };
 
 #endif /* StatusController_hpp */
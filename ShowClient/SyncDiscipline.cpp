@@ -0,0 +1,119 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "SyncDiscipline.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "utility/strutil.hpp"
+
+using namespace std::string_literals ;
+
+//======================================================================
+SyncDiscipline::Tuning::Tuning():proportional(0.1),integral(0.01),step(6.0),slew(0.02) {
+    
+}
+
+//======================================================================
+SyncDiscipline::Tuning::Tuning(const std::string &line):Tuning() {
+    auto values = util::parse(line,",") ;
+    try {
+        switch (values.size()) {
+            default:
+            case 4:{
+                slew = std::clamp(std::stod(values[3]), 0.0, 0.5) ;
+                [[fallthrough]] ;
+            }
+            case 3:{
+                step = std::max(std::stod(values[2]), 1.0) ;
+                [[fallthrough]] ;
+            }
+            case 2:{
+                integral = std::clamp(std::stod(values[1]), 0.0, 1.0) ;
+                [[fallthrough]] ;
+            }
+            case 1:{
+                proportional = std::clamp(std::stod(values[0]), 0.0, 1.0) ;
+                [[fallthrough]] ;
+            }
+            case 0:
+                break;
+        }
+    }
+    catch(...) {
+        throw std::runtime_error("Invalid sync loop: "s + line) ;
+    }
+}
+
+//======================================================================
+SyncDiscipline::SyncDiscipline() {
+    reset() ;
+}
+
+//======================================================================
+auto SyncDiscipline::setTuning(const Tuning &value) -> void {
+    tuning = value ;
+    correction = std::clamp(correction, -tuning.slew, tuning.slew) ;
+}
+
+//======================================================================
+auto SyncDiscipline::reset() -> void {
+    primed = false ;
+    held = false ;
+    lastReference = 0.0 ;
+    lastOffset = 0.0 ;
+    jitter = 0.0 ;
+    frequency = 0.0 ;
+    correction = 0.0 ;
+}
+
+//======================================================================
+auto SyncDiscipline::update(double offset, double reference) -> Action {
+    if (!primed || std::abs(offset) > tuning.step) {
+        // Too far to slew (or nothing to go on yet), the caller jumps to the reference.
+        // What we learned of the drift still holds
+        primed = true ;
+        held = false ;
+        lastReference = reference ;
+        lastOffset = 0.0 ;
+        correction = std::clamp(frequency, -tuning.slew, tuning.slew) ;
+        return std::abs(offset) >= 0.5 ? STEP : NONE ;
+    }
+    // How many frames since the last sample, the gains are per sample but the
+    // correction has to be spread over however long until the next one
+    auto elapsed = reference - lastReference ;
+    if (elapsed < 1.0) {
+        // Samples this close together tell us nothing new about the rate
+        return NONE ;
+    }
+    auto change = std::abs(offset - lastOffset) ;
+    if (!held && change > std::max(SPIKEFACTOR * jitter, SPIKEFLOOR)) {
+        // A spike (a delayed packet). If the next sample agrees it was real
+        held = true ;
+        return NONE ;
+    }
+    held = false ;
+    jitter += (change - jitter) / 4.0 ;
+    
+    frequency = std::clamp(frequency + (tuning.integral * offset) / elapsed, -tuning.slew, tuning.slew) ;
+    correction = std::clamp(frequency + (tuning.proportional * offset) / elapsed, -tuning.slew, tuning.slew) ;
+    lastReference = reference ;
+    lastOffset = offset ;
+    return SLEW ;
+}
+
+//======================================================================
+auto SyncDiscipline::rate() const -> double {
+    return correction ;
+}
+
+//======================================================================
+auto SyncDiscipline::offset() const -> double {
+    return lastOffset ;
+}
+
+//======================================================================
+auto SyncDiscipline::drift() const -> double {
+    return frequency ;
+}
@@ -0,0 +1,64 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef SyncDiscipline_hpp
+#define SyncDiscipline_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+//======================================================================
+// Keeps an output on the server's frame from the SYNC samples. Each sample
+// is how far ahead of the server we are (in frames). Spikes are held back
+// until they repeat, then a PI loop turns the offset into a fractional rate
+// correction (and its integral is our estimate of the clock drift). Only an
+// offset past the step threshold jumps the frame.
+class SyncDiscipline {
+public:
+    //======================================================================
+    // syncloop = proportional, integral, step (frames), slew (max rate correction)
+    struct Tuning {
+        double proportional ;   // fraction of the offset removed by the next sample
+        double integral ;       // fraction of the offset folded into the drift estimate
+        double step ;           // offsets past this many frames jump, rather than slew
+        double slew ;           // the most the rate is corrected, as a fraction
+        
+        Tuning() ;
+        Tuning(const std::string &line) ;
+    };
+    
+    enum Action {
+        NONE = 0, SLEW, STEP
+    };
+    // A spike this many times the jitter is held back, unless the next one agrees
+    static constexpr auto SPIKEFACTOR = 3.0 ;
+    static constexpr auto SPIKEFLOOR = 0.25 ;    // frames, so a quiet link does not make every sample a spike
+    
+private:
+    Tuning tuning ;
+    bool primed ;
+    bool held ;
+    double lastReference ;
+    double lastOffset ;
+    double jitter ;
+    double frequency ;
+    double correction ;
+    
+public:
+    SyncDiscipline() ;
+    
+    auto setTuning(const Tuning &value) -> void ;
+    // A new start, forget what we knew
+    auto reset() -> void ;
+    
+    // offset is our frame less the reference (server) frame, both at the same instant
+    auto update(double offset, double reference) -> Action ;
+    
+    // The fraction to lengthen our frame period by (negative shortens)
+    auto rate() const -> double ;
+    // The filtered offset and the drift estimate (the fraction our clock runs fast)
+    auto offset() const -> double ;
+    auto drift() const -> double ;
+};
+
+#endif /* SyncDiscipline_hpp */
@@ -0,0 +1,44 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "SyncMailbox.hpp"
+
+//======================================================================
+SyncMailbox::SyncMailbox():sequence(0),frame(0.0),stamp(0) {
+}
+
+//======================================================================
+auto SyncMailbox::post(double sync_frame, std::chrono::steady_clock::time_point when) -> void {
+    auto current = sequence.load(std::memory_order_relaxed) ;
+    sequence.store(current + 1, std::memory_order_relaxed) ;
+    std::atomic_thread_fence(std::memory_order_release) ;
+    frame.store(sync_frame, std::memory_order_relaxed) ;
+    stamp.store(std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch()).count(), std::memory_order_relaxed) ;
+    sequence.store(current + 2, std::memory_order_release) ;
+}
+
+//======================================================================
+auto SyncMailbox::take(std::uint64_t &seen, double &sync_frame, std::chrono::steady_clock::time_point &when) const -> bool {
+    auto before = sequence.load(std::memory_order_acquire) ;
+    // Mid post (or nothing new). We never wait on the poster, it may be the
+    // one we are keeping off the cpu; seen is left alone so the next take has it
+    if (before == seen || (before & 1) != 0) {
+        return false ;
+    }
+    auto value = frame.load(std::memory_order_relaxed) ;
+    auto at = stamp.load(std::memory_order_relaxed) ;
+    std::atomic_thread_fence(std::memory_order_acquire) ;
+    if (sequence.load(std::memory_order_relaxed) != before) {
+        // A post landed while we read, that one is for next time
+        return false ;
+    }
+    seen = before ;
+    sync_frame = value ;
+    when = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(at))) ;
+    return true ;
+}
+
+//======================================================================
+auto SyncMailbox::latest() const -> std::uint64_t {
+    // Mid post counts as the one being posted, it is not seen yet
+    return sequence.load(std::memory_order_acquire) & ~std::uint64_t(1) ;
+}
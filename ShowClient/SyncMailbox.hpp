@@ -0,0 +1,31 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef SyncMailbox_hpp
+#define SyncMailbox_hpp
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+//======================================================================
+// The latest SYNC, handed from the network thread to an output without a
+// lock. It is a seqlock: post never waits (there is one poster, the network
+// thread), a later post just replaces one not taken yet. take never waits
+// either: if it reads while a post is half done it gets nothing, and the
+// next take (the next tick or callback) has it. Each reader keeps the
+// sequence of the last one it took.
+class SyncMailbox {
+    std::atomic<std::uint64_t> sequence ;   // odd while a post is writing
+    std::atomic<double> frame ;
+    std::atomic<std::int64_t> stamp ;       // steady clock ns the frame was true at
+public:
+    SyncMailbox() ;
+    auto post(double sync_frame, std::chrono::steady_clock::time_point when) -> void ;
+    // True (with the frame and when it was true) if there has been a post after seen, which it updates.
+    // False (seen unchanged) if there is none, or one is being posted right now
+    auto take(std::uint64_t &seen, double &sync_frame, std::chrono::steady_clock::time_point &when) const -> bool ;
+    // The sequence of the last post, to ignore anything before now
+    auto latest() const -> std::uint64_t ;
+};
+
+#endif /* SyncMailbox_hpp */
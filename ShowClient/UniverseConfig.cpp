@@ -0,0 +1,55 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "UniverseConfig.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "utility/strutil.hpp"
+
+using namespace std::string_literals ;
+
+//======================================================================
+UniverseConfig::UniverseConfig():protocol(E131),universe(1),inputOffset(0),length(MAXSLOTS) {
+    
+}
+
+//======================================================================
+// line = protocol(E131,ARTNET),universe,address,offset,length
+UniverseConfig::UniverseConfig(const std::string &line):UniverseConfig() {
+    auto values = util::parse(line,",") ;
+    try {
+        switch (values.size()) {
+            default:
+            case 5:{
+                length = std::clamp(std::stoi(values[4],nullptr,0), 1, static_cast<int>(MAXSLOTS)) ;
+                [[fallthrough]] ;
+            }
+            case 4:{
+                inputOffset = std::max(std::stoi(values[3],nullptr,0), 0) ;
+                [[fallthrough]] ;
+            }
+            case 3:{
+                address = values[2] ;
+                [[fallthrough]] ;
+            }
+            case 2:{
+                universe = std::stoi(values[1],nullptr,0) ;
+                [[fallthrough]] ;
+            }
+            case 1:{
+                protocol = util::upper(values[0]) == "ARTNET" ? ARTNET : E131 ;
+                [[fallthrough]] ;
+            }
+            case 0:
+                break;
+        }
+    }
+    catch(...) {
+        throw std::runtime_error("Invalid universe: "s + line) ;
+    }
+    // E1.31 universes are 1 - 63999, Art-Net port addresses 0 - 32767
+    if ((protocol == E131 && (universe < 1 || universe > 63999)) || (protocol == ARTNET && (universe < 0 || universe > 32767))) {
+        throw std::runtime_error("Invalid universe: "s + line) ;
+    }
+}
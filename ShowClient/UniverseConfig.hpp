@@ -0,0 +1,28 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef UniverseConfig_hpp
+#define UniverseConfig_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+//======================================================================
+// A DMX universe we send over the network, taken from a slice of each light frame
+struct UniverseConfig {
+    enum Protocol {
+        E131 = 0, ARTNET
+    };
+    static constexpr auto MAXSLOTS = 512 ;
+    
+    Protocol protocol ;
+    int universe ;
+    std::string address ;   // empty sends E1.31 to the universe's multicast group, Art-Net to broadcast
+    int inputOffset ;
+    int length ;
+    
+    UniverseConfig() ;
+    UniverseConfig(const std::string &line) ;
+};
+
+#endif /* UniverseConfig_hpp */
@@ -4,6 +4,10 @@
 
 #include <fstream>
 #include <vector>
+#if defined(BEAGLE)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "utility/strutil.hpp"
 #include "utility/dbgutil.hpp"
@@ -11,7 +15,12 @@
 using namespace std::string_literals ;
 const std::string BeagleLed::led_location = "/sys/class/leds/beaglebone:green:usr%i"s;
 // =======================================================================================
-BeagleLed::BeagleLed(int number,const std::string &name):led_name(name),led_number(number){
+BeagleLed::BeagleLed(int number,const std::string &name):led_number(number),led_name(name),currentOnOffState(false),currentFlashState(false){
+#if defined(BEAGLE)
+    brightness_fd = -1 ;
+    trigger_fd = -1 ;
+    trigger_known = false ;
+#endif
 #if defined(BEAGLEBONE)
     currentState = LedState::OFF ;
     
@@ -24,12 +33,44 @@ BeagleLed::BeagleLed(int number,const std::string &name):led_name(name),led_numb
         }
     }
 #else
-    currentFlashState = false ;
-    currentOnOffState = false ;
     currentState = LedState::OFF ;
 #endif
 }
 
+// =======================================================================================
+BeagleLed::~BeagleLed() {
+#if defined(BEAGLE)
+    if (brightness_fd >= 0) {
+        ::close(brightness_fd) ;
+    }
+    if (trigger_fd >= 0) {
+        ::close(trigger_fd) ;
+    }
+#endif
+}
+
+#if defined(BEAGLE)
+// =======================================================================================
+// Opened the first time, and kept. A sysfs attribute takes each write as its
+// whole value, so there is no seeking or truncating to do
+auto BeagleLed::writeAttribute(int &fd, const std::string &attribute, const std::string &value) -> bool {
+    if (fd < 0) {
+        auto path = util::format(led_location,led_number) + "/"s + attribute ;
+        fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC) ;
+        if (fd < 0) {
+            return false ;
+        }
+    }
+    if (::pwrite(fd, value.data(), value.size(), 0) != static_cast<ssize_t>(value.size())) {
+        // Open it again next time
+        ::close(fd) ;
+        fd = -1 ;
+        return false ;
+    }
+    return true ;
+}
+#endif
+
 // =================================================================================
 auto BeagleLed::readFlash() -> bool {
 #if defined(BEAGLE)
@@ -81,35 +122,32 @@ auto BeagleLed::readOnOff() -> bool {
 // =======================================================================================
 auto BeagleLed::setOnOff(bool state ) -> bool {
 #if defined(BEAGLE)
-        auto path = util::format(led_location,led_number) ;
-        path += "/brightness"s ;
-        auto output = std::ofstream(path);
-        if (!output.is_open()){
-            return false ;
-        }
-        output << (state?"1"s:"0"s);
-        output.close();
-#else
-    currentOnOffState = state ;
+    if (!writeAttribute(brightness_fd, "brightness"s, state ? "1"s : "0"s)) {
+        return false ;
+    }
+    if (!state) {
+        trigger_known = true ;
+        currentFlashState = false ;
+    }
 #endif
+    currentOnOffState = state ;
     return true ;
 }
 // =======================================================================================
 auto BeagleLed::setFlash(bool state ) -> bool {
 #if defined(BEAGLE)
-    auto path = util::format(led_location,led_number) ;
-    path += "/trigger"s ;
-    auto output = std::ofstream(path);
-    if (!output.is_open()){
+    if (!state && trigger_known && !currentFlashState) {
+        // Nothing to take off
+        return true ;
+    }
+    if (!writeAttribute(trigger_fd, "trigger"s, state ? "timer"s : "none"s)) {
+        trigger_known = false ;
         return false ;
     }
-    output << (state?"timer"s:"none"s);
-    output.close();
-#else
-    currentFlashState = state ;
+    trigger_known = true ;
 #endif
+    currentFlashState = state ;
     return true ;
-    
 }
 
 // =======================================================================================
@@ -121,6 +159,14 @@ auto BeagleLed::number() const -> int {
     return led_number ;
 }
 // =======================================================================================
+auto BeagleLed::isOn() const -> bool {
+    return currentOnOffState ;
+}
+// =======================================================================================
+auto BeagleLed::isFlashing() const -> bool {
+    return currentFlashState ;
+}
+// =======================================================================================
 auto BeagleLed::describe() const -> std::string {
     
     std::string state = "Off" ;
@@ -139,6 +185,12 @@ auto BeagleLed::setState(LedState state,bool force) -> bool {
     if (state == currentState && !force) {
         return false ; // We didn't have to set anything
     }
+#if defined(BEAGLE)
+    if (force) {
+        // Whatever it is now, write it all
+        trigger_known = false ;
+    }
+#endif
     if (state == LedState::ON) {
         setFlash(false);
         setOnOff(true);
@@ -10,15 +10,24 @@ enum class LedState {
     OFF,ON,FLASH,UNKNOWN
 };
 
+// One of the user leds. On the beagle it writes the sysfs brightness and
+// trigger, keeping them open after the first write. Elsewhere it only keeps
+// what it was set to, which isOn and isFlashing report either way.
 class BeagleLed {
     static const std::string led_location ;
     int led_number ;
     std::string led_name ;
     LedState currentState ;
-    
-#if !defined(BEAGLEBONE)
+
     bool currentOnOffState ;
     bool currentFlashState ;
+#if defined(BEAGLE)
+    int brightness_fd ;
+    int trigger_fd ;
+    // Turning the brightness off drops the trigger, so we know there is none
+    // until we set one. Not at the start, someone else may have
+    bool trigger_known ;
+    auto writeAttribute(int &fd, const std::string &attribute, const std::string &value) -> bool ;
 #endif
 
     auto readOnOff() -> bool ;
@@ -28,9 +37,14 @@ class BeagleLed {
 public:
     // Led numbers 0 - 3
     BeagleLed(int number,const std::string &name = "") ;
+    ~BeagleLed() ;
+    BeagleLed(const BeagleLed&) = delete ;
+    auto operator=(const BeagleLed&) -> BeagleLed& = delete ;
     auto setState(LedState state,bool force = false ) -> bool ;
     auto state() const -> LedState ;
     auto number() const -> int ;
     auto describe() const -> std::string ;
+    auto isOn() const -> bool ;
+    auto isFlashing() const -> bool ;
 };
 #endif /* BeagleLed_hpp */
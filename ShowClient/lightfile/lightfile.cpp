@@ -70,6 +70,15 @@ auto LightFile::frameLength() const -> std::int32_t {
     return static_cast<std::int32_t>(lightHeader.frameLength) ;
 }
 
+//======================================================================
+auto LightFile::framePeriod() const -> std::chrono::nanoseconds {
+    if (lightHeader.sampleRate == 0) {
+        // Nothing useful in the header, the period everything was before
+        return std::chrono::milliseconds(37) ;
+    }
+    return std::chrono::milliseconds(lightHeader.sampleRate) ;
+}
+
 
 //======================================================================
 auto LightFile::dataForFrame(std::int32_t frame) const -> const std::uint8_t* {
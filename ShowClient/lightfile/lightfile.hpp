@@ -3,6 +3,7 @@
 #ifndef lightfile_hpp
 #define lightfile_hpp
 
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <string>
@@ -50,6 +51,8 @@ public:
     
     auto frameCount() const -> std::int32_t ;
     auto frameLength() const -> std::int32_t ;
+    // The header's sample rate
+    auto framePeriod() const -> std::chrono::nanoseconds ;
     auto dataForFrame(std::int32_t frame) const -> const std::uint8_t*;
     auto clear(bool nothrow = false) -> void ;
 };
@@ -3,6 +3,7 @@
 #include "lightheader.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include <vector>
 #include "utility/dbgutil.hpp"
@@ -42,12 +43,12 @@ auto LightHeader::load(const char *ptr) -> void {
         // we are going to "assume old format"?
         float check = 0.0 ;
         std::copy(ptr+1,ptr+5,reinterpret_cast<char*>(&check));
-        if ( int(check*1000) != 37) {
+        if (std::lround(check*1000) <= 0) {
             DBGMSG(std::cout,   "Bad frame period in older format");
             throw std::runtime_error("Unsupported light format");
         }
         // we need the frame acount and frame length
-        sampleRate = 37 ;
+        sampleRate = static_cast<std::uint32_t>(std::lround(check*1000)) ;
         
         std::copy(ptr+5,ptr+9,reinterpret_cast<char*>(&frameCount)) ;
         //DBGMSG(std::cout, "Frame count is : "s + std::to_string(frameCount));
@@ -87,12 +88,12 @@ auto LightHeader::load(std::istream &input) -> void {
         input.seekg(1,std::ios::beg) ;
         
         input.read(reinterpret_cast<char*>(&check),4) ;
-        if ( int(1000.0 * check) != 37) {
+        if (std::lround(1000.0 * check) <= 0) {
             DBGMSG(std::cout, "Bad frame period in older format");
             throw std::runtime_error("Unsupported light format");
         }
         // we need the frame acount and frame length
-        sampleRate = 37 ;
+        sampleRate = static_cast<std::uint32_t>(std::lround(1000.0 * check)) ;
         input.read(reinterpret_cast<char*>(&frameCount),4) ;
         input.read(reinterpret_cast<char*>(&frameLength),4) ;
         offsetToData = 13 ;
@@ -6,12 +6,23 @@
 #include <filesystem>
 #include <thread>
 #include <functional>
+#include <future>
+#include <memory>
+#include <set>
 
 #include "packets/allpackets.hpp"
+#include "network/FrameValue.hpp"
 #include "utility/dbgutil.hpp"
 #include "utility/strutil.hpp"
 
 #include "ClientConfiguration.hpp"
+#include "ClientStatistics.hpp"
+#include "ConfigWatcher.hpp"
+#include "ContentCache.hpp"
+#include "E131Bridge.hpp"
+#include "RelayServer.hpp"
+#include "SceneCache.hpp"
+#include "StartupTrace.hpp"
 #include "StatusController.hpp"
 #include "MusicController.hpp"
 #include "LightController.hpp"
@@ -20,10 +31,19 @@
 using namespace std::string_literals ;
 
 auto runLoop(ClientConfiguration &config) -> bool ;
+auto applyConfig(const ClientConfiguration &config, const std::set<std::string> &changed) -> void ;
+auto reloadConfig(ClientConfiguration *config, std::shared_ptr<asio::system_timer> schedule) -> void ;
+auto applyPending(ClientConfiguration *config, std::shared_ptr<asio::system_timer> schedule) -> void ;
+auto scheduleTick(const asio::error_code &ec, std::shared_ptr<asio::system_timer> timer, ClientConfiguration *config) -> void ;
+auto housekeepingTick(const asio::error_code &ec, std::shared_ptr<asio::steady_timer> timer, std::shared_ptr<asio::system_timer> schedule, ClientConfiguration *config) -> void ;
+auto finishRun() -> void ;
+auto endRun(const ClientConfiguration *config) -> void ;
+auto outputsReady(const ClientConfiguration *config) -> bool ;
 
 StatusController ledController ;
 
 int main(int argc, const char * argv[]) {
+    StartupTrace::instance().mark("main"s) ;
     ClientConfiguration configuration ;
     auto exitcode = EXIT_SUCCESS ;
     try {
@@ -33,6 +53,7 @@ int main(int argc, const char * argv[]) {
         if (!configuration.load(std::filesystem::path(argv[1]))){
             throw std::runtime_error("Unable to process: "s + argv[1]);
         }
+        StartupTrace::instance().mark("config"s) ;
         // We are now have our configuration file, lets start our run loop
         ledController.setState(StatusLed::RUN, LedState::OFF);
         if(!runLoop(configuration)) {
@@ -62,7 +83,7 @@ int main(int argc, const char * argv[]) {
 // Our main runloop
 // ============================================================================================================
 
-auto initialConnect(ClientPointer client) -> void ;
+auto initialConnect(ClientPointer client, const ClientConfiguration *config) -> void ;
 
 auto musicError(MusicPointer music) -> void ;
 
@@ -72,12 +93,37 @@ auto processPlay(ClientPointer connection,PacketPointer packet) -> bool;
 auto processShow(ClientPointer connection,PacketPointer packet) -> bool;
 auto processNop(ClientPointer connection,PacketPointer packet) -> bool;
 auto processBuffer(ClientPointer connection,PacketPointer packet) -> bool;
+auto processZBuffer(ClientPointer connection,PacketPointer packet) -> bool;
+auto processScene(ClientPointer connection,PacketPointer packet) -> bool;
 auto stopCallback(ClientPointer client) -> void ;
+auto connectionState(ClientPointer client, ClientState state, const ClientConfiguration *config) -> void ;
+auto sendStats(ClientPointer client) -> void ;
+auto showPlaying() -> bool ;
+auto startInstant(std::int64_t startTime) -> std::chrono::steady_clock::time_point ;
+auto reportStartSkew() -> void ;
+auto processPeer(RelayPeerPointer peer, PacketPointer packet) -> void ;
 
 MusicController musicController ;
 LightController lightController ;
+ContentCache contentCache ;
+SceneCache sceneCache ;
+RelayServer relayServer ;
+E131Bridge bridge ;
+ConfigWatcher configWatcher ;
 
 std::shared_ptr<Client> client  = nullptr ;
+// Set (on the client's context) when the run span ends
+std::promise<void> runDone ;
+bool runEnded = false ;
+bool runFailed = false ;
+// The hardware comes up in the background while we connect, nothing touches
+// the outputs on the client's context until outputsReady says it is done
+std::shared_future<void> lightsReady ;
+std::shared_future<bool> audioReady ;
+bool firstConnect = true ;
+constexpr auto HOUSEKEEPING = std::chrono::seconds(60) ;
+// A reload that changes the show, held until one is not playing
+std::unique_ptr<ClientConfiguration> pendingConfig = nullptr ;
 // ====================================================================
 auto runLoop(ClientConfiguration &config) -> bool {
     ledController.clear() ;
@@ -88,100 +134,356 @@ auto runLoop(ClientConfiguration &config) -> bool {
     routines.insert_or_assign(PacketType::SHOW,std::bind(&processShow,std::placeholders::_1,std::placeholders::_2)) ;
     routines.insert_or_assign(PacketType::NOP,std::bind(&processNop,std::placeholders::_1,std::placeholders::_2)) ;
     routines.insert_or_assign(PacketType::BUFFER,std::bind(&processBuffer,std::placeholders::_1,std::placeholders::_2)) ;
+    routines.insert_or_assign(PacketType::ZBUFFER,std::bind(&processZBuffer,std::placeholders::_1,std::placeholders::_2)) ;
+    routines.insert_or_assign(PacketType::SCENE,std::bind(&processScene,std::placeholders::_1,std::placeholders::_2)) ;
+    routines.insert_or_assign(PacketType::MANIFEST,std::bind(&ContentCache::processManifest,&contentCache,std::placeholders::_1,std::placeholders::_2)) ;
+    routines.insert_or_assign(PacketType::CHUNK,std::bind(&ContentCache::processChunk,&contentCache,std::placeholders::_1,std::placeholders::_2)) ;
     
-    client = std::make_shared<Client>(config.name,routines) ;
+    client = std::make_shared<Client>(config.name,routines,!config.sharedThread) ;
     client->setStopCallback(std::bind(&stopCallback,std::placeholders::_1));
-    client->setConnectdBeforeRead(std::bind(&initialConnect,std::placeholders::_1));
-    musicController.setEnabled(config.useAudio) ;
-    musicController.setDevice(config.audioDevice);
+    client->setConnectdBeforeRead(std::bind(&initialConnect,std::placeholders::_1,&config));
+    client->setStateCallback(std::bind(&connectionState,std::placeholders::_1,std::placeholders::_2,&config));
+    client->setProbeInterval(config.probeInterval) ;
+    client->setReportCallback(std::bind(&sendStats,std::placeholders::_1));
+    client->setStatsInterval(config.statsInterval) ;
+    client->setCapabilities(config.useCompression ? IdentPacket::ZBUFFER : IdentPacket::NONE) ;
+    asio::post(client->context(),[budget = config.sceneCache](){ sceneCache.setBudget(static_cast<size_t>(std::max(budget,0)) * 1024); }) ;
+    relayServer.setPeerRoutine(std::bind(&processPeer,std::placeholders::_1,std::placeholders::_2)) ;
+    relayServer.setQueueLimit(static_cast<size_t>(std::max(config.relayQueue,1)) * 1024) ;
+    relayServer.start(client->context(), config.relayPort) ;
+    client->setForwardRoutine(std::bind(&RelayServer::forward,&relayServer,std::placeholders::_1)) ;
+    if (!client->setSyncPort(config.syncPort)) {
+        DBGMSG(std::cerr, "Unable to open sync port: "s + std::to_string(config.syncPort));
+    }
     musicController.setDataInformation(config.musicPath, config.musicExtension);
     musicController.setMusicErrorCallback(std::bind(&musicError,std::placeholders::_1));
-    lightController.setPRUInfo(config.pruSetting[0], config.pruSetting[1]) ;
-    lightController.setEnabled(config.useLight) ;
-    lightController.clear() ;
+    // Mapping the prus and finding the audio device are the slow parts, and
+    // neither needs the other (or the network)
+    lightsReady = std::async(std::launch::async,[pru0 = config.pruSetting[0], pru1 = config.pruSetting[1], universes = config.universes, name = config.name, enabled = config.useLight](){
+        lightController.setPRUInfo(pru0, pru1) ;
+        lightController.setUniverses(universes, name) ;
+        lightController.setEnabled(enabled) ;
+        lightController.clear() ;
+        StartupTrace::instance().mark("lights"s) ;
+    }).share() ;
+    audioReady = std::async(std::launch::async,[enabled = config.useAudio, device = config.audioDevice](){
+        musicController.setEnabled(enabled) ;
+        musicController.setDevice(device);
+        auto ready = musicController.initialize(device) ;
+        StartupTrace::instance().mark("audio"s) ;
+        return ready ;
+    }).share() ;
+    lightController.setFrameClock(std::bind(&MusicController::audioFrame,&musicController,std::placeholders::_1,std::placeholders::_2), config.audioClock) ;
+    lightController.setSyncTuning(config.syncTuning) ;
+    lightController.setTimerSpin(std::chrono::microseconds(config.timerSpin)) ;
+    musicController.setSyncTuning(config.syncTuning) ;
+    bridge.setOutputRoutine(std::bind(&LightController::showFrame,&lightController,std::placeholders::_1,std::placeholders::_2)) ;
+    bridge.setReportInterval(config.statsInterval) ;
     lightController.setDataInformation(config.lightPath, config.lightExtension);
-    while (config.runSpan.inRange()) {
-        ledController.setState(StatusLed::RUN, LedState::ON) ;
+    contentCache.setLocation(ManifestPacket::MUSIC, config.musicPath, config.musicExtension) ;
+    contentCache.setLocation(ManifestPacket::LIGHT, config.lightPath, config.lightExtension) ;
+    contentCache.setBusyCheck(std::bind(&showPlaying)) ;
+    // From here everything is on the client's context: timers for each edge of
+    // the run span and connect hours, and a slow one for housekeeping
+    ledController.setState(StatusLed::RUN, LedState::ON) ;
+    StartupTrace::instance().mark("client"s) ;
+    auto schedule = std::make_shared<asio::system_timer>(client->context()) ;
+    auto housekeeping = std::make_shared<asio::steady_timer>(client->context(), HOUSEKEEPING) ;
+    asio::post(client->context(),std::bind(&scheduleTick,asio::error_code(),schedule,&config)) ;
+    // After the first connect is under way. Whether or not we ever connect, a
+    // failed start ends the run, and the bridge (it writes to the prus) waits
+    // for them
+    asio::post(client->context(),[&config](){
+        if (outputsReady(&config)) {
+            bridge.start(config.inputs) ;
+        }
+    });
+    housekeeping->async_wait(std::bind(&housekeepingTick,std::placeholders::_1,housekeeping,schedule,&config)) ;
+    if (!configWatcher.start(client->context(), config.file(), std::bind(&reloadConfig,&config,schedule))) {
+        DBGMSG(std::cerr, "Polling the configuration file instead"s);
+    }
+    if (config.sharedThread) {
+        // Everything (but the light output and the audio device) runs right here
+        if (!lightController.setRealtime(true)) {
+            DBGMSG(std::cerr, "Unable to run the light output with real time priority"s);
+        }
+        client->run() ;
+    }
+    else {
+        runDone.get_future().wait() ;
+    }
+    // Runs may end before the hardware is up
+    lightsReady.wait() ;
+    audioReady.wait() ;
+    client = nullptr ;
+    return !runFailed ;
+}
+
+// ====================================================================
+// Keys that change what is playing (or how we get it), they wait for the show to end
+const auto SHOWKEYS = std::set<std::string>{"AUDIO"s, "AUDIODEVICE"s, "MUSICPATH"s, "MUSICEXTENSION"s, "LIGHTS"s, "LIGHTPATH"s, "LIGHTEXTENSION"s, "UNIVERSE"s, "NAME"s, "PRU"s, "AUDIOCLOCK"s, "SERVER"s, "CLIENTPORT"s, "BINDFALLBACK"s, "SYNCPORT"s} ;
+
+auto anyOf(const std::set<std::string> &changed, const std::set<std::string> &keys) -> bool {
+    for (const auto &key : keys) {
+        if (changed.contains(key)) {
+            return true ;
+        }
+    }
+    return false ;
+}
+
+// ====================================================================
+// The config file changed, pass on only what did. The prus and lights are
+// not here, applyPending does them before taking the new configuration
+auto applyConfig(const ClientConfiguration &config, const std::set<std::string> &changed) -> void {
+    if (anyOf(changed, {"AUDIO"s})) {
+        musicController.setEnabled(config.useAudio) ;
+    }
+    if (anyOf(changed, {"AUDIODEVICE"s})) {
+        musicController.setDevice(config.audioDevice);
+    }
+    if (anyOf(changed, {"MUSICPATH"s, "MUSICEXTENSION"s})) {
+        musicController.setDataInformation(config.musicPath, config.musicExtension);
+        contentCache.setLocation(ManifestPacket::MUSIC, config.musicPath, config.musicExtension) ;
+    }
+    if (anyOf(changed, {"UNIVERSE"s, "NAME"s})) {
+        lightController.setUniverses(config.universes, config.name) ;
+    }
+    if (anyOf(changed, {"AUDIOCLOCK"s})) {
+        lightController.setFrameClock(std::bind(&MusicController::audioFrame,&musicController,std::placeholders::_1,std::placeholders::_2), config.audioClock) ;
+    }
+    if (anyOf(changed, {"SYNCLOOP"s})) {
+        lightController.setSyncTuning(config.syncTuning) ;
+        musicController.setSyncTuning(config.syncTuning) ;
+    }
+    if (anyOf(changed, {"TIMERSPIN"s})) {
+        lightController.setTimerSpin(std::chrono::microseconds(config.timerSpin)) ;
+    }
+    if (anyOf(changed, {"LIGHTPATH"s, "LIGHTEXTENSION"s})) {
+        lightController.setDataInformation(config.lightPath, config.lightExtension);
+        contentCache.setLocation(ManifestPacket::LIGHT, config.lightPath, config.lightExtension) ;
+    }
+    if (anyOf(changed, {"STATSINTERVAL"s})) {
+        bridge.setReportInterval(config.statsInterval) ;
+        client->setStatsInterval(config.statsInterval) ;
+    }
+    if (anyOf(changed, {"INPUT"s})) {
+        bridge.start(config.inputs) ;
+    }
+    if (anyOf(changed, {"SYNCPORT"s})) {
+        client->setSyncPort(config.syncPort) ;
+    }
+    if (anyOf(changed, {"PROBEINTERVAL"s})) {
+        client->setProbeInterval(config.probeInterval) ;
+    }
+    if (anyOf(changed, {"COMPRESSION"s})) {
+        client->setCapabilities(config.useCompression ? IdentPacket::ZBUFFER : IdentPacket::NONE) ;
+    }
+    if (anyOf(changed, {"SCENECACHE"s})) {
+        sceneCache.setBudget(static_cast<size_t>(std::max(config.sceneCache,0)) * 1024) ;
+    }
+    if (anyOf(changed, {"RELAYQUEUE"s})) {
+        relayServer.setQueueLimit(static_cast<size_t>(std::max(config.relayQueue,1)) * 1024) ;
+    }
+    if (anyOf(changed, {"RELAYPORT"s})) {
+        relayServer.start(client->context(), config.relayPort) ;
+    }
+    if (anyOf(changed, {"SERVER"s, "CLIENTPORT"s, "BINDFALLBACK"s}) && client->isRunning()) {
+        client->start(config.serverIP, config.serverPort, config.clientPort, config.bindFallback) ;
+    }
+}
+
+// ====================================================================
+// On the client's context (the only place config is read once we are
+// running). The file is read into a new configuration, so a bad edit leaves
+// the one we have alone
+auto reloadConfig(ClientConfiguration *config, std::shared_ptr<asio::system_timer> schedule) -> void {
+    auto fresh = std::make_unique<ClientConfiguration>() ;
+    try {
+        if (!config->refresh(*fresh)) {
+            return ;
+        }
+    }
+    catch(const std::exception &e) {
+        DBGMSG(std::cerr, "Keeping the current configuration: "s + e.what());
+        return ;
+    }
+    pendingConfig = std::move(fresh) ;
+    applyPending(config, schedule) ;
+}
+
+// ====================================================================
+auto applyPending(ClientConfiguration *config, std::shared_ptr<asio::system_timer> schedule) -> void {
+    if (pendingConfig == nullptr || !outputsReady(config)) {
+        return ;
+    }
+    auto changed = config->changes(*pendingConfig) ;
+    if (showPlaying() && anyOf(changed, SHOWKEYS)) {
+        DBGMSG(std::cout, "Configuration change is waiting for the show to end"s);
+        return ;
+    }
+    if (changed.contains("THREADING"s)) {
+        // The threads are what they are until we restart
+        DBGMSG(std::cerr, "Threading change takes effect on restart"s);
+        pendingConfig->sharedThread = config->sharedThread ;
+    }
+    auto fresh = std::move(pendingConfig) ;
+    // Turning the lights on checks the pru firmware and can fail, so it goes
+    // first; if it does we put the prus back and stay on what we had
+    auto restoreLights = [config](){
         try {
-            if (config.refresh()) {
-                // We shoud set anything we need to because the config file changed
-                musicController.setEnabled(config.useAudio) ;
-                musicController.setDevice(config.audioDevice);
-                musicController.setDataInformation(config.musicPath, config.musicExtension);
-                lightController.setEnabled(config.useLight) ;
-                lightController.setDataInformation(config.lightPath, config.lightExtension);
-                
-            }
+            lightController.setPRUInfo(config->pruSetting[0], config->pruSetting[1]) ;
+            lightController.setEnabled(config->useLight) ;
         }
         catch(...) {
-            // We had an error processing the config file, but we aren't going to worry about it, we did it initially, we will assume we can continue
         }
-        if (config.connectTime.inRange()) {
-            // We should be connected!
-            if (!client->is_open()) {
-                
-                ledController.setState(StatusLed::CONNECT, LedState::FLASH) ;
-                musicController.stop() ;
-                lightController.stop() ;
-                lightController.clear() ;
-                ledController.setState(StatusLed::PLAY, LedState::OFF) ;
-                ledController.setState(StatusLed::SHOW, LedState::OFF) ;
-
-            
-                // we are not open!
-                if (client->connect(config.serverIP, config.serverPort, config.clientPort)) {
-                    // We connected!
-                    DBGMSG(std::cout,"Connected to "s + config.serverIP+":"s+std::to_string(config.serverPort));
-                    ledController.setState(StatusLed::CONNECT, LedState::ON) ;
-                    // We need to setup everything!
-                }
-                else {
-                    // We didn't connect, could because we are still holding onto the port we binded to,
-                    // that takes about 40 to 60 seconds to release
-                    std::this_thread::sleep_for(std::chrono::seconds(10));
-                }
-            }
-            if (client->is_open()){
-                
-                // this is where our action is
-                
-                if (client->expire(180)) {
-                    // It has been three minutes since we got something, we probably should just disconnect
-                    
-                    if (client->is_open()) {
-                        client->shutdown() ;
-                        
-                        client->close() ;
-                        musicController.stop();
-                        lightController.stop();
-                    }
-                }
-            }
+    };
+    try {
+        if (anyOf(changed, {"PRU"s, "LIGHTS"s})) {
+            lightController.setPRUInfo(fresh->pruSetting[0], fresh->pruSetting[1]) ;
+            lightController.setEnabled(fresh->useLight) ;
         }
-        else {
-            // We should  be closed down
-            if (client->is_open()){
-                client->close() ;
-                musicController.stop();
-                lightController.stop() ;
-                lightController.clear() ;
-                ledController.setState(StatusLed::SHOW, LedState::OFF);
-                ledController.setState(StatusLed::PLAY, LedState::OFF);
-                ledController.setState(StatusLed::CONNECT, LedState::OFF) ;
-            }
+    }
+    catch(const std::exception &e) {
+        DBGMSG(std::cerr, "Keeping the current configuration, the lights could not be changed: "s + e.what());
+        restoreLights() ;
+        return ;
+    }
+    catch(...) {
+        DBGMSG(std::cerr, "Keeping the current configuration, the lights could not be changed"s);
+        restoreLights() ;
+        return ;
+    }
+    *config = *fresh ;
+    auto keys = std::string() ;
+    for (const auto &key : changed) {
+        keys += (keys.empty() ? ""s : ", "s) + key ;
+    }
+    DBGMSG(std::cout, "Configuration changed: "s + (keys.empty() ? "nothing"s : keys));
+    try {
+        applyConfig(*config, changed) ;
+    }
+    catch(const std::exception &e) {
+        DBGMSG(std::cerr, "Error applying the configuration: "s + e.what());
+    }
+    catch(...) {
+        DBGMSG(std::cerr, "Error applying the configuration"s);
+    }
+    if (anyOf(changed, {"CONNECTHOURS"s, "RUNSPAN"s})) {
+        // The windows moved
+        scheduleTick(asio::error_code(), schedule, config) ;
+    }
+}
+
+// ====================================================================
+// At each edge of the run span and the connect hours (and whenever the config
+// changes them, and every housekeeping tick). Sleeps until the next one
+auto scheduleTick(const asio::error_code &ec, std::shared_ptr<asio::system_timer> timer, ClientConfiguration *config) -> void {
+    if (ec == asio::error::operation_aborted || runEnded) {
+        return ;
+    }
+    auto now = util::ourclock::now() ;
+    if (!config->runSpan.inRange(now)) {
+        endRun(config) ;
+        return ;
+    }
+    if (config->connectTime.inRange(now)) {
+        // We should be connected, the client keeps reconnecting on its own while running
+        if (!client->isRunning()) {
+            StartupTrace::instance().mark("connecting"s) ;
+            client->start(config->serverIP, config->serverPort, config->clientPort, config->bindFallback) ;
         }
-        
-        
-        
-        std::this_thread::sleep_for(std::chrono::seconds(1));
     }
-    ledController.setState(StatusLed::RUN, LedState::OFF) ;
-    
-    if (client->is_open()){
-        client->close();
+    else {
+        // We should  be closed down
+        if (client->isRunning() && outputsReady(config)){
+            client->stop() ;
+            musicController.stop();
+            lightController.stop() ;
+            lightController.clear() ;
+            ledController.setState(StatusLed::SHOW, LedState::OFF);
+            ledController.setState(StatusLed::PLAY, LedState::OFF);
+            ledController.setState(StatusLed::CONNECT, LedState::OFF) ;
+        }
+    }
+    auto next = std::min(config->runSpan.nextChange(now), config->connectTime.nextChange(now)) ;
+    if (next != util::ourclock::time_point::max()) {
+        timer->expires_at(next) ;
+        timer->async_wait(std::bind(&scheduleTick,std::placeholders::_1,timer,config)) ;
     }
-    client = nullptr ;
-    return true ;
+}
+
+// ====================================================================
+// What is not tied to the schedule: a config change waiting on the show (or
+// the file, if it is not watched), and a server gone quiet. And the schedule
+// itself again, its timer is armed for a wall clock time but only counts down
+// the time to it, so a step in the clock (the first ntp sync on a board with
+// no rtc) would otherwise go unnoticed
+auto housekeepingTick(const asio::error_code &ec, std::shared_ptr<asio::steady_timer> timer, std::shared_ptr<asio::system_timer> schedule, ClientConfiguration *config) -> void {
+    if (ec == asio::error::operation_aborted || runEnded) {
+        return ;
+    }
+    if (!configWatcher.isWatching()) {
+        reloadConfig(config, schedule) ;
+    }
+    // Anything held for a show that has since ended
+    applyPending(config, schedule) ;
+    scheduleTick(asio::error_code(), schedule, config) ;
+    if (runEnded) {
+        return ;
+    }
+    if (client->is_open() && client->expire(180)) {
+        // It has been three minutes since we got something, drop it and let the client reconnect
+        client->shutdown() ;
+        client->close() ;
+        musicController.stop();
+        lightController.stop();
+    }
+    timer->expires_at(timer->expiry() + HOUSEKEEPING) ;
+    timer->async_wait(std::bind(&housekeepingTick,std::placeholders::_1,timer,schedule,config)) ;
+}
+
+// ====================================================================
+// On the client's context
+auto endRun(const ClientConfiguration *config) -> void {
+    runEnded = true ;
+    finishRun() ;
+    if (config->sharedThread) {
+        client->context().stop() ;
+    }
+    runDone.set_value() ;
+}
+
+// ====================================================================
+// On the client's context. Waits for the hardware to be up (only ever the
+// first time), false if it could not be and the run is over
+auto outputsReady(const ClientConfiguration *config) -> bool {
+    if (runEnded) {
+        return false ;
+    }
+    try {
+        lightsReady.get() ;
+        audioReady.wait() ;
+        return true ;
+    }
+    catch(const std::exception &e) {
+        DBGMSG(std::cerr, "Unable to start the lights: "s + e.what());
+    }
+    catch(...) {
+        DBGMSG(std::cerr, "Unable to start the lights"s);
+    }
+    runFailed = true ;
+    endRun(config) ;
+    return false ;
+}
+
+// ====================================================================
+auto finishRun() -> void {
+    ledController.setState(StatusLed::RUN, LedState::OFF) ;
+    bridge.stop() ;
+    configWatcher.stop() ;
+    relayServer.stop() ;
+    client->stop() ;
 }
 
 // ==============================================================================================
@@ -189,6 +491,8 @@ auto runLoop(ClientConfiguration &config) -> bool {
 // ==============================================================================================
 
 bool load_error = false ;
+// The frame period of what is loaded, the light file says (all of them if nothing does)
+auto show_period = std::chrono::nanoseconds(IOController::FRAMEPERIOD) ;
 
 // ==============================================================================================
 auto processLoad(ClientPointer connection,PacketPointer packet) -> bool {
@@ -198,6 +502,8 @@ auto processLoad(ClientPointer connection,PacketPointer packet) -> bool {
     
     auto music = payload->musicName() ;
     auto light = payload->lightName() ;
+    auto begin = std::chrono::steady_clock::now() ;
+    show_period = IOController::FRAMEPERIOD ;
     //DBGMSG(std::cout, util::format("Load: %s, %s",music.c_str(),light.c_str()));
     if (musicController.isEnabled()){
         if (!musicController.load(music)) {
@@ -216,15 +522,29 @@ auto processLoad(ClientPointer connection,PacketPointer packet) -> bool {
             client->send(packet);
             ledController.setState(StatusLed::PLAY, LedState::FLASH) ;
         }
+        else {
+            show_period = lightController.filePeriod() ;
+        }
+    }
+    else {
+        // The show's period is only in the light file, the audio plays to it too
+        show_period = lightController.periodOf(light) ;
     }
+    ClientStatistics::instance().recordLoad(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin)) ;
     return true ;
 }
 
 // ==============================================================================================
 auto processSync(ClientPointer connection,PacketPointer packet) -> bool {
     auto payload = static_cast<SyncPacket*>(packet.get()) ;
+    if (packet->stampGap().count() >= 0) {
+        // Stamped with the kernel arrival time, note how far behind that we were
+        ClientStatistics::instance().recordReceiveGap(packet->stampGap()) ;
+    }
     
-    auto frame = payload->syncFrame() ;
+    // The frame was the server's when it sent it, that is the one way delay before we received it
+    auto stamp = packet->time() - std::chrono::duration_cast<util::ourclock::duration>(connection->latency().delay()) ;
+    auto frame = FrameValue(payload->syncFrame(),stamp).position(show_period) ;
     musicController.syncFrame(frame);
     lightController.syncFrame(frame);
     return true ;
@@ -237,10 +557,30 @@ auto processPlay(ClientPointer connection,PacketPointer packet) -> bool {
     auto frame = payload->frame() ;
     
     if (state) {
+        auto at = std::chrono::steady_clock::time_point() ;
+        if (payload->startTime() != 0) {
+            at = startInstant(payload->startTime()) ;
+        }
+        else {
+            // Without a start time, frame is where the server was when it sent
+            // this. Start a whole number of frames on from then, far enough out
+            // the audio can pad to it
+            constexpr auto STARTMARGIN = std::chrono::milliseconds(100) ;
+            auto now = std::chrono::steady_clock::now() ;
+            auto since = std::chrono::duration_cast<std::chrono::nanoseconds>((util::ourclock::now() - packet->time()) + connection->latency().delay()) ;
+            auto sent = now - std::max(since, std::chrono::nanoseconds(0)) ;
+            auto ahead = ((now + STARTMARGIN - sent) + show_period - std::chrono::nanoseconds(1)) / show_period ;
+            frame += static_cast<std::int32_t>(ahead) ;
+            at = sent + (ahead * show_period) ;
+        }
         auto got_play_error = false ;
+        // First get everything ready (the audio stream open and running silent) ...
+        auto musicPrepared = false ;
+        auto lightPrepared = false ;
         if (musicController.isEnabled()){
             if (musicController.isLoaded()){
-                if (!musicController.start(frame)) {
+                musicPrepared = musicController.prepare(frame, show_period) ;
+                if (!musicPrepared) {
                     DBGMSG(std::cout, "Error on "s + musicController.name());
                     auto packet = ErrorPacket(ErrorPacket::CatType::AUDIO, musicController.name());
                     client->send(packet);
@@ -259,7 +599,8 @@ auto processPlay(ClientPointer connection,PacketPointer packet) -> bool {
         }
         if (lightController.isEnabled()){
             if (lightController.isLoaded()) {
-                if (!lightController.start(frame)) {
+                lightPrepared = lightController.prepare(frame, show_period) ;
+                if (!lightPrepared) {
                     auto packet = ErrorPacket(ErrorPacket::CatType::LIGHT, lightController.name());
                     client->send(packet);
                     ledController.setState(StatusLed::PLAY, LedState::FLASH) ;
@@ -275,6 +616,16 @@ auto processPlay(ClientPointer connection,PacketPointer packet) -> bool {
 
             }
         }
+        // ... then start them together
+        if (musicPrepared) {
+            musicController.commit(at) ;
+        }
+        if (lightPrepared) {
+            lightController.commit(at) ;
+        }
+        if (musicPrepared && lightPrepared) {
+            connection->runAt(at + std::chrono::seconds(1), std::bind(&reportStartSkew)) ;
+        }
         if (!got_play_error && !load_error) {
             ledController.setState(StatusLed::PLAY, LedState::ON) ;
         }
@@ -289,6 +640,38 @@ auto processPlay(ClientPointer connection,PacketPointer packet) -> bool {
     return true ;
 }
 
+// ==============================================================================================
+// Where a PLAY start time falls on our steady clock. Both clocks are read
+// together, so the system clock only has to be right (ntp/ptp), not steady.
+auto startInstant(std::int64_t startTime) -> std::chrono::steady_clock::time_point {
+    constexpr auto MAXSTARTWAIT = std::chrono::seconds(30) ;
+    auto now = std::chrono::steady_clock::now() ;
+    if (startTime == 0) {
+        return now ;
+    }
+    auto wall = std::chrono::duration_cast<std::chrono::microseconds>(util::ourclock::now().time_since_epoch()) ;
+    auto wait = std::chrono::microseconds(startTime) - wall ;
+    if (wait > MAXSTARTWAIT) {
+        DBGMSG(std::cerr, "Play start is "s + std::to_string(wait.count()) + " us away, starting now (clock error "s + std::to_string(util::clockError()) + " us)"s);
+        return now ;
+    }
+    if (wait.count() < 0) {
+        DBGMSG(std::cout, "Play arrived "s + std::to_string(-wait.count()) + " us after its start"s);
+    }
+    return now + wait ;
+}
+
+// ==============================================================================================
+// Both outputs have had time to put out their first frame/sample, so see how they lined up
+auto reportStartSkew() -> void {
+    if (!musicController.hasFirstOutput() || !lightController.hasFirstOutput()) {
+        return ;
+    }
+    auto skew = musicController.startLanding() - lightController.startLanding() ;
+    ClientStatistics::instance().recordStartSkew(skew) ;
+    DBGMSG(std::cout, "Start skew (audio - light) for "s + musicController.name() + ": "s + std::to_string(skew.count()) + " us"s);
+}
+
 // ==============================================================================================
 auto processShow(ClientPointer connection,PacketPointer packet) -> bool {
     auto payload = static_cast<ShowPacket*>(packet.get()) ;
@@ -302,7 +685,13 @@ auto processNop(ClientPointer connection,PacketPointer packet) -> bool {
     auto payload = static_cast<NopPacket*>(packet.get()) ;
     auto respond = payload->respond() ;
     if (respond) {
-        connection->send(NopPacket()) ;
+        // Echo their time, so they can measure the round trip, and tell them our estimate
+        auto reply = NopPacket() ;
+        reply.setEchoTime(payload->originTime()) ;
+        if (connection->latency().isValid()) {
+            reply.setDelay(static_cast<std::int32_t>(connection->latency().delay().count())) ;
+        }
+        connection->send(reply) ;
     }
     return true ;
 }
@@ -312,13 +701,89 @@ auto processBuffer(ClientPointer connection,PacketPointer packet) -> bool{
     auto length = payload->length()  - 8 ;
     auto data = std::vector<std::uint8_t>(length,0) ;
     //DBGMSG(std::cout, "We think the buffer to load is: "s + std::to_string(length));
-    lightController.loadBuffer(payload->packetData());
+    if (lightController.loadBuffer(payload->packetData()) && lightController.isEnabled()) {
+        sceneCache.store(lightController.buffer()) ;
+    }
+    musicController.clear() ;
+    return true ;
+}
+
+// ================================================================================================
+auto processZBuffer(ClientPointer connection,PacketPointer packet) -> bool{
+    auto payload = static_cast<ZBufferPacket*>(packet.get()) ;
+    if (!lightController.loadBuffer(*payload)) {
+        DBGMSG(std::cerr, "Unable to load compressed buffer");
+    }
+    else if (lightController.isEnabled()) {
+        sceneCache.store(lightController.buffer()) ;
+    }
     musicController.clear() ;
     return true ;
 }
+
+// ================================================================================================
+auto processScene(ClientPointer connection,PacketPointer packet) -> bool{
+    auto payload = static_cast<ScenePacket*>(packet.get()) ;
+    if (!lightController.isEnabled()) {
+        // Same as a buffer, we swallow it
+        return true ;
+    }
+    auto scene = sceneCache.find(payload->hash()) ;
+    ClientStatistics::instance().recordScene(scene != nullptr) ;
+    if (scene == nullptr || !lightController.loadBuffer(*scene)) {
+        auto miss = ScenePacket(payload->hash(), true) ;
+        connection->send(miss) ;
+        return true ;
+    }
+    musicController.clear() ;
+    return true ;
+}
+// ================================================================================================
+auto processPeer(RelayPeerPointer peer, PacketPointer packet) -> void {
+    switch (packet->packetID()) {
+        case PacketType::IDENT: {
+            try {
+                peer->setName(static_cast<IdentPacket*>(packet.get())->handle()) ;
+                DBGMSG(std::cout, "Relay peer "s + peer->peer() + " is "s + peer->name());
+            }
+            catch(...) {
+                // Too short to have a name
+            }
+            break ;
+        }
+        case PacketType::NOP: {
+            // We are their server, so we answer their probes
+            auto payload = static_cast<NopPacket*>(packet.get()) ;
+            if (payload->respond()) {
+                auto reply = NopPacket() ;
+                reply.setEchoTime(payload->originTime()) ;
+                peer->send(reply) ;
+            }
+            break ;
+        }
+        case PacketType::SCENE: {
+            // A scene we relayed they do not have, send it as a buffer if we kept it
+            auto payload = static_cast<ScenePacket*>(packet.get()) ;
+            if (packet->size() >= static_cast<std::uint32_t>(ScenePacket::PACKETSIZE) && payload->miss()) {
+                auto scene = sceneCache.find(payload->hash()) ;
+                if (scene != nullptr) {
+                    peer->send(BufferPacket(*scene)) ;
+                }
+            }
+            break ;
+        }
+        default:
+            // Their reports and errors are for the server, which does not know them
+            break ;
+    }
+}
+
 // ================================================================================================
 auto stopCallback(ClientPointer client) -> void {
     // We stopped, so we have some cleanup, but lets do a few things
+    contentCache.cancel() ;
+    // Our peers follow us, they should not be left thinking a show is on
+    relayServer.disconnectPeers() ;
     // We should turn of playing
     ledController.setState(StatusLed::PLAY, LedState::OFF) ;
     musicController.stop() ;
@@ -326,6 +791,48 @@ auto stopCallback(ClientPointer client) -> void {
     ledController.setState(StatusLed::SHOW, LedState::OFF) ;
 }
 
+// ================================================================================================
+auto connectionState(ClientPointer client, ClientState state, const ClientConfiguration *config) -> void {
+    switch (state) {
+        case ClientState::CONNECTED:
+            ledController.setState(StatusLed::CONNECT, LedState::ON) ;
+            StartupTrace::instance().finish("connected"s) ;
+            // The first report covers this connection
+            ClientStatistics::instance().reset() ;
+            break;
+        case ClientState::WAITING:
+            // We lost the server (or have not found it), so nothing should be going
+            ledController.setState(StatusLed::CONNECT, LedState::FLASH) ;
+            if (!outputsReady(config)) {
+                break ;
+            }
+            musicController.stop() ;
+            lightController.stop() ;
+            lightController.clear() ;
+            ledController.setState(StatusLed::PLAY, LedState::OFF) ;
+            ledController.setState(StatusLed::SHOW, LedState::OFF) ;
+            break;
+        case ClientState::RESOLVING:
+        case ClientState::CONNECTING:
+            ledController.setState(StatusLed::CONNECT, LedState::FLASH) ;
+            break;
+        default:
+            break;
+    }
+}
+
+// ================================================================================================
+auto showPlaying() -> bool {
+    return musicController.isPlaying() || lightController.isPlaying() ;
+}
+
+// ================================================================================================
+auto sendStats(ClientPointer client) -> void {
+    auto delay = client->latency().isValid() ? static_cast<std::int32_t>(client->latency().delay().count()) : -1 ;
+    auto packet = ClientStatistics::instance().report(delay) ;
+    client->send(packet) ;
+}
+
 // ================================================================================================
 auto musicError(MusicPointer music) -> void {
     DBGMSG(std::cout, "Error on "s + musicController.name());
@@ -336,8 +843,14 @@ auto musicError(MusicPointer music) -> void {
 }
 
 // ================================================================================================
-auto initialConnect(ClientPointer client) -> void {
-    if (!musicController.initialize(musicController.device()) ) {
+auto initialConnect(ClientPointer client, const ClientConfiguration *config) -> void {
+    if (!outputsReady(config)) {
+        return ;
+    }
+    // The first connect has the audio brought up at startup, after that it is opened again each time
+    auto ready = firstConnect ? audioReady.get() : musicController.initialize(musicController.device()) ;
+    firstConnect = false ;
+    if (!ready) {
         auto errorPacket = ErrorPacket(ErrorPacket::CatType::AUDIO,"") ;
         client->send(errorPacket);
         ledController.setState(StatusLed::PLAY, LedState::FLASH) ;
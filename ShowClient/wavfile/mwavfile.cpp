@@ -53,7 +53,7 @@ using namespace std::string_literals ;
  ************************************************************************************************ */
 
 //======================================================================
-MWAVFile::MWAVFile():currentOffset(0),ptrToData(nullptr),dataSize(0) {
+MWAVFile::MWAVFile():frame_period(std::chrono::milliseconds(37)),currentOffset(0),ptrToData(nullptr),dataSize(0) {
     
 }
 
@@ -158,7 +158,7 @@ auto  MWAVFile::fileName() const -> std::string {
 
 //======================================================================
 auto MWAVFile::setFrame(std::int32_t frame) -> bool {
-    auto time = (SSDRATE * double(frame))  ;
+    auto time = std::chrono::duration<double>(frame_period).count() * double(frame) ;
     auto sample = std::round(double(formatChunk.sampleRate) * time) ;
     auto offset = static_cast<std::int32_t>(sample) * formatChunk.samplesize ;
     if (offset >= static_cast<int>(dataSize)){
@@ -167,6 +167,31 @@ auto MWAVFile::setFrame(std::int32_t frame) -> bool {
     currentOffset = offset ;
     return true ;
 }
+//======================================================================
+auto MWAVFile::setFramePeriod(std::chrono::nanoseconds period) -> void {
+    if (period.count() > 0) {
+        frame_period = period ;
+    }
+}
+
+//======================================================================
+auto MWAVFile::skip(std::uint32_t samplecount) -> void {
+    currentOffset = std::min(currentOffset + (static_cast<size_t>(samplecount) * formatChunk.samplesize), static_cast<size_t>(dataSize)) ;
+}
+
+//======================================================================
+auto MWAVFile::position() const -> std::uint32_t {
+    if (formatChunk.samplesize == 0) {
+        return 0 ;
+    }
+    return static_cast<std::uint32_t>(currentOffset / formatChunk.samplesize) ;
+}
+
+//======================================================================
+auto MWAVFile::seek(std::uint32_t sample) -> void {
+    currentOffset = std::min(static_cast<size_t>(sample) * formatChunk.samplesize, static_cast<size_t>(dataSize)) ;
+}
+
 //======================================================================
 auto MWAVFile::loadBuffer(std::uint8_t *buffer, std::uint32_t samplecount ) -> std::uint32_t {
     auto location = currentOffset ;
@@ -186,7 +211,7 @@ auto MWAVFile::frameCount() const -> std::int32_t {
         return 0 ;
     }
     auto seconds = ( double(dataSize) / double(formatChunk.samplesize)) / double(formatChunk.sampleRate) ;
-    return std::int32_t(std::round(seconds/SSDRATE)) ;
+    return std::int32_t(std::round(seconds/std::chrono::duration<double>(frame_period).count())) ;
     
 }
 
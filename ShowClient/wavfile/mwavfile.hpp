@@ -3,6 +3,7 @@
 #ifndef mwavfile_hpp
 #define mwavfile_hpp
 
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <string>
@@ -53,7 +54,8 @@
 
 class MWAVFile {
 private:
-    static constexpr auto SSDRATE = 0.037 ;
+    // How long a frame is, for setFrame and frameCount (the show's, from its light file)
+    std::chrono::nanoseconds frame_period ;
     
     util::MapFile memoryMap ;
     size_t currentOffset ;
@@ -76,8 +78,14 @@ public:
     auto fileName() const -> std::string ;
     
     auto setFrame(std::int32_t frame) -> bool ;
+    auto setFramePeriod(std::chrono::nanoseconds period) -> void ;
     
     auto loadBuffer(std::uint8_t *buffer, std::uint32_t samplecount ) -> std::uint32_t ;
+    // Move ahead without reading
+    auto skip(std::uint32_t samplecount) -> void ;
+    // The sample the next loadBuffer starts at
+    auto position() const -> std::uint32_t ;
+    auto seek(std::uint32_t sample) -> void ;
     
     auto frameCount() const -> std::int32_t ;
     
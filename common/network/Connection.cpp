@@ -2,8 +2,11 @@
 
 #include "Connection.hpp"
 
+#include <cerrno>
 #include <fstream>
 
+#include "KernelTimestamp.hpp"
+
 #include "utility/dbgutil.hpp"
 #include "utility/strutil.hpp"
 #include "utility/timeutil.hpp"
@@ -11,57 +14,113 @@
 using namespace std::string_literals ;
 
 //======================================================================
-auto Connection::read(int amount, int offset) -> void {
-    if (netSocket.is_open()) {
-        incomingAmount = amount ;
-        asio::async_read(this->netSocket,asio::buffer(incomingPacket->data.data()+offset,amount),std::bind(&Connection::readHandler,this->shared_from_this(), std::placeholders::_1, std::placeholders::_2));
+auto Connection::readLoop(std::uint64_t mine) -> asio::awaitable<void> {
+    // The loop holds on to us for as long as it runs, rather than every read taking a reference
+    auto self = this->shared_from_this() ;
+    while (netSocket.is_open()) {
+        asio::error_code ec ;
+        auto bytes_transferred = co_await this->receive(ec) ;
+        if (mine != generation) {
+            // Our socket was closed and another opened, it is nothing to do with us
+            co_return ;
+        }
+        if (ec) {
+            //DBGMSG(std::cerr, "Error on read: "s + ec.message());
+            DBGMSG(std::cout, util::format("Read %llu packets in %llu reads",static_cast<unsigned long long>(packetCount),static_cast<unsigned long long>(readCount)));
+            this->readFailed() ;
+            co_return ;
+        }
+        if (!this->process(bytes_transferred)) {
+            co_return ;
+        }
     }
 }
 
 //======================================================================
-auto Connection::readHandler(const asio::error_code& ec, size_t bytes_transferred) -> void {
-    if (ec) {
-        //DBGMSG(std::cerr, "Error on read: "s + ec.message());
-        try {
-            this->timestamp() ; // mark the event
-            // We got an error, so we wont requeue our read
-            if (closeCallback != nullptr) {
-                 closeCallback(this->shared_from_this()) ;
-            }
-            if (netSocket.is_open()) {
-                netSocket.close();
+auto Connection::receive(asio::error_code &ec) -> asio::awaitable<std::size_t> {
+    if (!kernelStamps) {
+        co_return co_await netSocket.async_read_some(receiveBuffer.prepare(receiveNeeded), asio::redirect_error(asio::use_awaitable, ec)) ;
+    }
+    // We do the read ourselves once there is data, so we can get the arrival time with it
+    while (true) {
+        co_await netSocket.async_wait(asio::ip::tcp::socket::wait_read, asio::redirect_error(asio::use_awaitable, ec)) ;
+        if (ec) {
+            co_return 0 ;
+        }
+        auto buffer = receiveBuffer.prepare(receiveNeeded) ;
+        auto size = std::size_t(0) ;
+        auto stamped = false ;
+        auto amount = KernelTimestamp::receive(netSocket.native_handle(), buffer.data(), buffer.size(), nullptr, size, arrival, stamped) ;
+        if (amount < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                continue ;
             }
+            ec = asio::error_code(errno, asio::error::get_system_category()) ;
+            co_return 0 ;
         }
-        catch(...){}
-        
-        return ;
-        
-    }
-    if (bytes_transferred != incomingAmount) {
-        // We should have gotten more?
-        auto amount = incomingAmount - static_cast<int>(bytes_transferred) ;
-        this->read( amount , incomingPacket->size() - amount ) ;
-        return ;
+        if (amount == 0) {
+            ec = asio::error::eof ;
+            co_return 0 ;
+        }
+        haveArrival = stamped ;
+        co_return static_cast<std::size_t>(amount) ;
     }
-    if (incomingPacket->length() != incomingPacket->size()) {
-        // We need more data!
-        auto amount = incomingPacket->length() - incomingPacket->size() ;
-        incomingPacket->resize(incomingPacket->length()) ;
-        this->read(amount,incomingPacket->size() - amount) ;
-        return ;
+}
+
+//======================================================================
+auto Connection::readFailed() -> void {
+    try {
+        this->timestamp() ; // mark the event
+        // We got an error, so we wont requeue our read
+        if (closeCallback != nullptr) {
+             closeCallback(this->shared_from_this()) ;
+        }
+        if (netSocket.is_open()) {
+            netSocket.close();
+        }
     }
-    // We got what we need
+    catch(...){}
+}
+
+//======================================================================
+auto Connection::process(std::size_t bytes_transferred) -> bool {
+    readCount += 1 ;
+    receiveBuffer.commit(bytes_transferred) ;
     lastRead = util::ourclock::now() ;
+    receiveNeeded = 0 ;
     
-    //
-    auto status = true ;
-    if (processingCallback != nullptr) {
-        status = processingCallback(incomingPacket,this->shared_from_this()) ;
-    }
-    if (status) {
-        this->read() ;
+    // Process every complete packet we have
+    while (receiveBuffer.available() >= static_cast<std::size_t>(Packet::PACKETHEADERSIZE)) {
+        auto length = Packet::lengthFromHeader(receiveBuffer.data()) ;
+        if (length < static_cast<std::uint32_t>(Packet::PACKETHEADERSIZE) || length > maxPacketLength) {
+            // We can not trust anything more on this stream
+            DBGMSG(std::cerr, "Invalid packet length: "s + std::to_string(length) + " from "s + this->peer());
+            this->readFailed() ;
+            return false ;
+        }
+        if (receiveBuffer.available() < length) {
+            // Make sure the next read has room for the rest of it
+            receiveNeeded = length - receiveBuffer.available() ;
+            break ;
+        }
+        auto packet = std::make_shared<Packet>(std::vector<std::uint8_t>(receiveBuffer.data(),receiveBuffer.data() + length)) ;
+        if (haveArrival) {
+            packet->stamp(arrival) ;
+        }
+        else {
+            packet->stamp() ;
+        }
+        receiveBuffer.consume(length) ;
+        packetCount += 1 ;
+        auto status = true ;
+        if (processingCallback != nullptr) {
+            status = processingCallback(packet,this->shared_from_this()) ;
+        }
+        if (!status || !netSocket.is_open()) {
+            return false ;
+        }
     }
-    
+    return true ;
 }
 
 //======================================================================
@@ -85,7 +144,7 @@ auto Connection::resolve(const std::string &ipaddress, std::uint16_t port) -> as
 }
 
 // =====================================================================
-Connection::Connection(asio::io_context &context):netSocket(context), incomingAmount(0), processingCallback(nullptr), closeCallback(nullptr), connectTime(util::ourclock::now()), lastRead(util::ourclock::now()), lastWrite(util::ourclock::now()) {
+Connection::Connection(asio::io_context &context):netSocket(context), receiveNeeded(0), maxPacketLength(MAXPACKETLENGTH), readCount(0), packetCount(0), kernelStamps(false), haveArrival(false), writing(false), generation(0), processingCallback(nullptr), closeCallback(nullptr), connectTime(util::ourclock::now()), lastRead(util::ourclock::now()), lastWrite(util::ourclock::now()) {
     
 }
 
@@ -117,8 +176,7 @@ auto Connection::is_open() const -> bool{
 //======================================================================
 auto Connection::read() -> void {
     if (netSocket.is_open()) {
-        incomingPacket = std::make_shared<Packet>(PacketType::UNKNOWN,Packet::PACKETHEADERSIZE) ;
-        this->read(Packet::PACKETHEADERSIZE,0) ;
+        asio::co_spawn(netSocket.get_executor(), this->readLoop(generation), asio::detached) ;
     }
 }
 
@@ -194,6 +252,31 @@ auto Connection::connect(asio::ip::tcp::endpoint &endpoint) -> bool {
     return true ;
 }
 
+//======================================================================
+auto Connection::connect(const asio::ip::tcp::endpoint &endpoint, ConnectHandler handler) -> void {
+    if (!netSocket.is_open()) {
+        DBGMSG(std::cerr, "Can not connect, socket was not open.");
+        asio::post(netSocket.get_executor(),std::bind(handler,asio::error_code(asio::error::bad_descriptor))) ;
+        return ;
+    }
+    netSocket.async_connect(endpoint,[self = this->shared_from_this(),handler](const asio::error_code &ec){
+        if (ec) {
+            if (self->netSocket.is_open()) {
+                asio::error_code ignore ;
+                self->netSocket.close(ignore) ;
+            }
+        }
+        else {
+            // We need to get our peer information ;
+            self->setPeer() ;
+            self->timestamp() ;
+        }
+        if (handler != nullptr) {
+            handler(ec) ;
+        }
+    });
+}
+
 //======================================================================
 auto Connection::open(std::uint16_t port) -> bool {
     asio::error_code ec ;
@@ -229,6 +312,16 @@ auto Connection::open() -> bool {
     if (netSocket.is_open()) {
         netSocket.close();
     }
+    // A new stream
+    receiveBuffer.clear() ;
+    receiveNeeded = 0 ;
+    haveArrival = false ;
+    {
+        auto lock = std::lock_guard(send_access) ;
+        pending.clear() ;
+        writing = false ;
+        generation += 1 ;
+    }
     try {
         netSocket.open(asio::ip::tcp::v4(),ec) ;
         if (ec) {
@@ -236,6 +329,7 @@ auto Connection::open() -> bool {
             return false ;
         }
         netSocket.set_option(asio::socket_base::keep_alive(true)) ;
+        kernelStamps = KernelTimestamp::enable(netSocket.native_handle()) ;
         return true ;
     }
     catch(...) {
@@ -279,25 +373,59 @@ auto Connection::clearWriteTime() -> void {
 
 //======================================================================
 auto Connection::send(const Packet &packet) -> bool {
-    asio::error_code ec ;
     if (!netSocket.is_open()) {
         return false ;
     }
-    try {
-        auto amount = asio::write(this->netSocket,asio::buffer(packet.data.data(),packet.size()),ec)  ;
+    auto start = false ;
+    auto mine = std::uint64_t(0) ;
+    {
+        auto lock = std::lock_guard(send_access) ;
+        pending.insert(pending.end(), packet.data.begin(), packet.data.begin() + packet.size()) ;
+        start = !writing ;
+        writing = true ;
+        mine = generation ;
+    }
+    if (start) {
+        // Outside the lock, the loop can start running right here
+        asio::co_spawn(netSocket.get_executor(), this->writeLoop(mine), asio::detached) ;
+    }
+    return true ;
+}
+
+//======================================================================
+auto Connection::writeLoop(std::uint64_t mine) -> asio::awaitable<void> {
+    auto self = this->shared_from_this() ;
+    while (true) {
+        {
+            auto lock = std::lock_guard(send_access) ;
+            if (mine != generation) {
+                // Reopened, what is pending (and writing) is the new socket's
+                co_return ;
+            }
+            outgoing.clear() ;
+            if (pending.empty()) {
+                writing = false ;
+                co_return ;
+            }
+            std::swap(pending, outgoing) ;
+        }
+        asio::error_code ec ;
+        co_await asio::async_write(netSocket, asio::buffer(outgoing), asio::redirect_error(asio::use_awaitable, ec)) ;
         if (ec) {
             //DBGMSG(std::cerr, "Write failed: "s + ec.message()) ;
-            return false ;
-        }
-        auto status = amount == packet.size() ;
-        if (status) {
-            lastWrite = util::ourclock::now() ;
+            {
+                auto lock = std::lock_guard(send_access) ;
+                if (mine != generation) {
+                    co_return ;
+                }
+                pending.clear() ;
+                writing = false ;
+            }
+            // The read loop sees the connection go, and handles the close
+            this->shutdown() ;
+            co_return ;
         }
-        return  status ;
-        
-    }
-    catch(...) {
-        return false ;
+        lastWrite = util::ourclock::now() ;
     }
 }
 
@@ -311,3 +439,18 @@ auto Connection::shutdown() -> void {
         catch(...){}
     }
 }
+
+//======================================================================
+auto Connection::setMaxPacketLength(std::uint32_t length) -> void {
+    maxPacketLength = length ;
+}
+
+//======================================================================
+auto Connection::reads() const -> std::uint64_t {
+    return readCount ;
+}
+
+//======================================================================
+auto Connection::packets() const -> std::uint64_t {
+    return packetCount ;
+}
@@ -3,16 +3,19 @@
 #ifndef Connection_hpp
 #define Connection_hpp
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
 #include <ostream>
 #include <mutex>
+#include <vector>
 
 #include "asio.hpp"
 
 #include "packets/Packet.hpp"
 #include "utility/timeutil.hpp"
+#include "ReceiveBuffer.hpp"
 
 class Connection;
 
@@ -23,6 +26,7 @@ class Connection: public std::enable_shared_from_this<Connection> {
 public:
     using PacketProcessing = std::function<bool(PacketPointer,ConnectionPointer)> ;
     using CloseCallback = std::function<void(ConnectionPointer)>;
+    using ConnectHandler = std::function<void(const asio::error_code&)>;
 private:
     asio::ip::tcp::socket netSocket ;
     
@@ -33,18 +37,42 @@ private:
     std::string peer_address ;
     std::string peer_port ;
     
-    PacketPointer incomingPacket ;
-    int incomingAmount ;
-
-    auto read(int amount, int offset) -> void ;
-    auto readHandler(const asio::error_code& ec, size_t bytes_transferred) -> void ;
-    //mutable std::recursive_mutex read_access;
+    ReceiveBuffer receiveBuffer ;
+    std::size_t receiveNeeded ;
+    std::uint32_t maxPacketLength ;
+    std::uint64_t readCount ;
+    std::uint64_t packetCount ;
+    
+    // When the kernel stamps what we receive, packets take the arrival time of the read
+    // that completed them, instead of when we parsed them
+    bool kernelStamps ;
+    bool haveArrival ;
+    util::ourclock::time_point arrival ;
+
+    // Sends are appended to pending, and the write loop swaps it with outgoing to put on
+    // the wire, so the buffers keep their capacity and a burst of sends goes out in one write
+    std::mutex send_access ;
+    std::vector<std::uint8_t> pending ;
+    std::vector<std::uint8_t> outgoing ;
+    bool writing ;
+    // Each open is a new one. A loop from an earlier socket can still resume
+    // (aborted) after we reopen, it sees it is not its socket and just goes
+    std::atomic<std::uint64_t> generation ;
+
+    auto readLoop(std::uint64_t mine) -> asio::awaitable<void> ;
+    auto receive(asio::error_code &ec) -> asio::awaitable<std::size_t> ;
+    auto process(std::size_t bytes_transferred) -> bool ;
+    auto writeLoop(std::uint64_t mine) -> asio::awaitable<void> ;
+    auto readFailed() -> void ;
 
     PacketProcessing processingCallback ;
     CloseCallback closeCallback ;
 
     
 public:
+    // Anything claiming to be longer than this is a corrupt stream (largest packets are a BUFFER, or a file chunk)
+    static constexpr std::uint32_t MAXPACKETLENGTH = 256 * 1024 ;
+    
     static auto resolve(const std::string &ipaddress, std::uint16_t port) -> asio::ip::tcp::endpoint ;
 
     std::string handle ;
@@ -66,6 +94,7 @@ public:
     auto stampedTime() const -> std::string ;
     
     auto connect(asio::ip::tcp::endpoint &endpoint) -> bool ;
+    auto connect(const asio::ip::tcp::endpoint &endpoint, ConnectHandler handler) -> void ;
     auto open(std::uint16_t port) -> bool ;
     auto open() -> bool ;
     
@@ -76,8 +105,14 @@ public:
     auto clearReadTime() -> void ;
     auto clearWriteTime() -> void ;
 
+    // Queues the packet, it is written from the io_context thread. False if we are not open
     auto send(const Packet &packet) -> bool ;
     
+    auto setMaxPacketLength(std::uint32_t length) -> void ;
+    // How many reads (recv calls) and packets we have had, so we can see how many packets each read brings in
+    auto reads() const -> std::uint64_t ;
+    auto packets() const -> std::uint64_t ;
+    
     auto shutdown() -> void ;
 };
 
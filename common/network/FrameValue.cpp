@@ -13,14 +13,25 @@
 FrameValue::FrameValue(int frame_value,bool no_adjust):frame(frame_value),noadjust(no_adjust),timestamp(util::ourclock::now()) {}
 
 // ==================================================================================================
-auto FrameValue::value() const -> int {
+FrameValue::FrameValue(int frame_value, const util::ourclock::time_point &stamp):timestamp(stamp),frame(frame_value),noadjust(false) {}
+
+// ==================================================================================================
+auto FrameValue::value(std::chrono::nanoseconds period) const -> int {
     if (noadjust) {
         return frame;
     }
-    auto adjustment = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(util::ourclock::now() - timestamp).count()/37) ;
+    auto adjustment = static_cast<int>((util::ourclock::now() - timestamp) / period) ;
     return frame + adjustment ;
 }
 
+// ==================================================================================================
+auto FrameValue::position(std::chrono::nanoseconds period) const -> double {
+    if (noadjust) {
+        return frame ;
+    }
+    return frame + (std::chrono::duration<double,std::nano>(util::ourclock::now() - timestamp).count() / static_cast<double>(period.count())) ;
+}
+
 // ==================================================================================================
 auto FrameValue::rawValue() -> int {
     return frame ;
@@ -17,7 +17,12 @@ class FrameValue {
     bool noadjust ;
 public:
     FrameValue(int frame_value = 0,bool no_adjust = false) ;
-    auto value() const -> int ;
+    // A frame value that was true at the time point (such as when the server sent it)
+    FrameValue(int frame_value, const util::ourclock::time_point &stamp) ;
+    // Adjusted for the time since, at the show's frame period
+    auto value(std::chrono::nanoseconds period) const -> int ;
+    // The same, with how far into that frame we are
+    auto position(std::chrono::nanoseconds period) const -> double ;
     auto rawValue() -> int ;
 };
 
@@ -0,0 +1,59 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "KernelTimestamp.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <time.h>
+#endif
+
+//======================================================================
+auto KernelTimestamp::enable(Handle handle) -> bool {
+#if defined(__linux__)
+    int on = 1 ;
+    return ::setsockopt(handle, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) == 0 ;
+#else
+    return false ;
+#endif
+}
+
+//======================================================================
+auto KernelTimestamp::receive(Handle handle, void *data, std::size_t size, void *from, std::size_t &fromSize, util::ourclock::time_point &stamp, bool &stamped) -> std::int64_t {
+    stamped = false ;
+#if defined(__linux__)
+    auto vector = iovec{data, size} ;
+    // Room for the timespec, aligned the way the kernel wants it
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(timespec))] ;
+    auto message = msghdr() ;
+    message.msg_name = from ;
+    message.msg_namelen = from == nullptr ? 0 : static_cast<socklen_t>(fromSize) ;
+    message.msg_iov = &vector ;
+    message.msg_iovlen = 1 ;
+    message.msg_control = control ;
+    message.msg_controllen = sizeof(control) ;
+    
+    auto amount = ::recvmsg(handle, &message, MSG_DONTWAIT) ;
+    if (amount < 0) {
+        return -1 ;
+    }
+    if (from != nullptr) {
+        fromSize = message.msg_namelen ;
+    }
+    for (auto header = CMSG_FIRSTHDR(&message) ; header != nullptr ; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_TIMESTAMPNS) {
+            auto arrival = timespec() ;
+            std::memcpy(&arrival, CMSG_DATA(header), sizeof(arrival)) ;
+            // SO_TIMESTAMPNS is CLOCK_REALTIME, the same clock as ourclock
+            stamp = util::ourclock::time_point(std::chrono::duration_cast<util::ourclock::duration>(std::chrono::seconds(arrival.tv_sec) + std::chrono::nanoseconds(arrival.tv_nsec))) ;
+            stamped = true ;
+        }
+    }
+    return static_cast<std::int64_t>(amount) ;
+#else
+    errno = EOPNOTSUPP ;
+    return -1 ;
+#endif
+}
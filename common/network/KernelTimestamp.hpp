@@ -0,0 +1,31 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef KernelTimestamp_hpp
+#define KernelTimestamp_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+#include "asio.hpp"
+
+#include "utility/timeutil.hpp"
+
+// ==================================================================================================
+// Receive with the time the kernel took the data off the wire (SO_TIMESTAMPNS), rather than when
+// our io thread got around to reading it.  Only Linux gives us this; everywhere else enable() is
+// false and the callers stay on the normal asio reads, stamping packets in userspace.
+// ==================================================================================================
+class KernelTimestamp {
+public:
+    // tcp and udp sockets share the same native descriptor type
+    using Handle = asio::ip::udp::socket::native_handle_type ;
+    
+    static auto enable(Handle handle) -> bool ;
+    
+    // A non blocking recvmsg. Returns the bytes read (0 for end of stream), or -1 with errno set.
+    // If from is given, it is filled with the sender and fromSize updated to its length.
+    // stamped is false when the kernel did not give an arrival time (stamp is left alone)
+    static auto receive(Handle handle, void *data, std::size_t size, void *from, std::size_t &fromSize, util::ourclock::time_point &stamp, bool &stamped) -> std::int64_t ;
+};
+
+#endif /* KernelTimestamp_hpp */
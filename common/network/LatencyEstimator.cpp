@@ -0,0 +1,75 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "LatencyEstimator.hpp"
+
+#include <algorithm>
+
+// ==================================================================================================
+LatencyEstimator::LatencyEstimator():sampleCount(0),nextSample(0),filteredDelay(0),filteredOffset(0),lastRtt(0),valid(false) {
+    
+}
+
+// ==================================================================================================
+auto LatencyEstimator::addSample(const util::ourclock::time_point &sent, const util::ourclock::time_point &received, std::int64_t remoteTime) -> void {
+    auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(received - sent).count() ;
+    if (rtt < 0) {
+        // The clock was stepped while the probe was out
+        return ;
+    }
+    auto sample = Sample{rtt,0,false} ;
+    if (remoteTime != 0) {
+        auto midpoint = std::chrono::duration_cast<std::chrono::microseconds>(sent.time_since_epoch()).count() + rtt/2 ;
+        sample.offset = remoteTime - midpoint ;
+        sample.hasOffset = true ;
+    }
+    samples[nextSample] = sample ;
+    nextSample = (nextSample + 1) % WINDOW ;
+    sampleCount = std::min(sampleCount + 1, static_cast<int>(WINDOW)) ;
+    lastRtt = rtt ;
+    
+    auto best = std::min_element(samples.begin(),samples.begin() + sampleCount,[](const Sample &lhs, const Sample &rhs){
+        return lhs.rtt < rhs.rtt ;
+    });
+    auto delay = best->rtt / 2 ;
+    if (!valid) {
+        filteredDelay = delay ;
+        filteredOffset = best->offset ;
+        valid = true ;
+        return ;
+    }
+    // Smooth it, a quarter of the way to the new value
+    filteredDelay = filteredDelay + (delay - filteredDelay) / 4 ;
+    if (best->hasOffset) {
+        filteredOffset = filteredOffset + (best->offset - filteredOffset) / 4 ;
+    }
+}
+
+// ==================================================================================================
+auto LatencyEstimator::clear() -> void {
+    sampleCount = 0 ;
+    nextSample = 0 ;
+    filteredDelay = 0 ;
+    filteredOffset = 0 ;
+    lastRtt = 0 ;
+    valid = false ;
+}
+
+// ==================================================================================================
+auto LatencyEstimator::isValid() const -> bool {
+    return valid ;
+}
+
+// ==================================================================================================
+auto LatencyEstimator::delay() const -> std::chrono::microseconds {
+    return std::chrono::microseconds(filteredDelay.load()) ;
+}
+
+// ==================================================================================================
+auto LatencyEstimator::offset() const -> std::chrono::microseconds {
+    return std::chrono::microseconds(filteredOffset.load()) ;
+}
+
+// ==================================================================================================
+auto LatencyEstimator::rtt() const -> std::chrono::microseconds {
+    return std::chrono::microseconds(lastRtt.load()) ;
+}
@@ -0,0 +1,51 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef LatencyEstimator_hpp
+#define LatencyEstimator_hpp
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "utility/timeutil.hpp"
+
+// ==================================================================================================
+// Keeps a filtered estimate of the one way network delay (and clock offset) to the server,
+// from round trip samples of timestamped NOP exchanges.  Like ntp, the sample with the smallest
+// round trip in the recent window is the one least delayed by queueing, so that is the one used,
+// and it is then smoothed so a single sample can not move the estimate far.
+// ==================================================================================================
+class LatencyEstimator {
+public:
+    static constexpr auto WINDOW = 8 ;
+private:
+    struct Sample {
+        std::int64_t rtt ;          // microseconds
+        std::int64_t offset ;       // microseconds, server clock - our clock
+        bool hasOffset ;
+    };
+    std::array<Sample,WINDOW> samples ;
+    int sampleCount ;
+    int nextSample ;
+    
+    // These are read from other threads
+    std::atomic<std::int64_t> filteredDelay ;
+    std::atomic<std::int64_t> filteredOffset ;
+    std::atomic<std::int64_t> lastRtt ;
+    std::atomic<bool> valid ;
+public:
+    LatencyEstimator() ;
+    
+    // sent/received are our clock, remoteTime is the server's clock (microseconds since the epoch)
+    // when it replied, 0 if it did not tell us
+    auto addSample(const util::ourclock::time_point &sent, const util::ourclock::time_point &received, std::int64_t remoteTime = 0) -> void ;
+    auto clear() -> void ;
+    
+    auto isValid() const -> bool ;
+    auto delay() const -> std::chrono::microseconds ;
+    auto offset() const -> std::chrono::microseconds ;
+    auto rtt() const -> std::chrono::microseconds ;
+};
+
+#endif /* LatencyEstimator_hpp */
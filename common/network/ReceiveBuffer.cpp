@@ -0,0 +1,63 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "ReceiveBuffer.hpp"
+
+#include <algorithm>
+
+// ==================================================================================================
+ReceiveBuffer::ReceiveBuffer(std::size_t chunksize):storage(chunksize * 2,0),head(0),tail(0),chunk(chunksize) {
+    
+}
+
+// ==================================================================================================
+auto ReceiveBuffer::prepare(std::size_t needed) -> asio::mutable_buffer {
+    auto room = std::max(chunk, needed) ;
+    if (storage.size() - tail < room) {
+        // Move what we have not parsed down to the front
+        if (head != 0) {
+            std::copy(storage.begin() + head, storage.begin() + tail, storage.begin()) ;
+            tail -= head ;
+            head = 0 ;
+        }
+        if (storage.size() - tail < room) {
+            storage.resize(tail + room) ;
+        }
+    }
+    return asio::buffer(storage.data() + tail, storage.size() - tail) ;
+}
+
+// ==================================================================================================
+auto ReceiveBuffer::commit(std::size_t amount) -> void {
+    tail = std::min(tail + amount, storage.size()) ;
+}
+
+// ==================================================================================================
+auto ReceiveBuffer::data() const -> const std::uint8_t* {
+    return storage.data() + head ;
+}
+
+// ==================================================================================================
+auto ReceiveBuffer::available() const -> std::size_t {
+    return tail - head ;
+}
+
+// ==================================================================================================
+auto ReceiveBuffer::consume(std::size_t amount) -> void {
+    head = std::min(head + amount, tail) ;
+    if (head == tail) {
+        // Nothing left, so start back at the front
+        head = 0 ;
+        tail = 0 ;
+    }
+}
+
+// ==================================================================================================
+auto ReceiveBuffer::clear() -> void {
+    head = 0 ;
+    tail = 0 ;
+    if (storage.size() > chunk * 2) {
+        // Give back anything a large packet made us grow to
+        storage.resize(chunk * 2) ;
+        storage.shrink_to_fit() ;
+    }
+}
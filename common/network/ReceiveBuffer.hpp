@@ -0,0 +1,36 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef ReceiveBuffer_hpp
+#define ReceiveBuffer_hpp
+
+#include <cstdint>
+#include <vector>
+
+#include "asio.hpp"
+
+// ==================================================================================================
+// The buffer a connection reads into, in large chunks, so one read can bring in many packets.
+// Data is parsed from the front and read into the back; whatever partial packet is left at the
+// front is moved down when the back runs out of room, so the storage is allocated once and reused.
+// ==================================================================================================
+class ReceiveBuffer {
+    std::vector<std::uint8_t> storage ;
+    std::size_t head ;      // start of the data not yet consumed
+    std::size_t tail ;      // end of the data read
+    std::size_t chunk ;     // the amount we want to have room for on each read
+public:
+    static constexpr std::size_t DEFAULTCHUNK = 16384 ;
+    
+    ReceiveBuffer(std::size_t chunksize = DEFAULTCHUNK) ;
+    
+    // Room for the next read (at least the chunk size, or what is needed to complete a packet)
+    auto prepare(std::size_t needed = 0) -> asio::mutable_buffer ;
+    auto commit(std::size_t amount) -> void ;
+    
+    auto data() const -> const std::uint8_t* ;
+    auto available() const -> std::size_t ;
+    auto consume(std::size_t amount) -> void ;
+    auto clear() -> void ;
+};
+
+#endif /* ReceiveBuffer_hpp */
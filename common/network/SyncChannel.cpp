@@ -0,0 +1,185 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "SyncChannel.hpp"
+
+#include <cerrno>
+
+#include "KernelTimestamp.hpp"
+
+#include "utility/dbgutil.hpp"
+#include "packets/DatagramPacket.hpp"
+
+using namespace std::string_literals ;
+
+//======================================================================
+auto SyncChannel::read() -> void {
+    if (udpSocket.is_open()) {
+        if (kernelStamps) {
+            udpSocket.async_wait(asio::ip::udp::socket::wait_read,std::bind(&SyncChannel::waitHandler,this->shared_from_this(),std::placeholders::_1)) ;
+            return ;
+        }
+        udpSocket.async_receive_from(asio::buffer(receiveBuffer), senderEndpoint, std::bind(&SyncChannel::readHandler,this->shared_from_this(),std::placeholders::_1,std::placeholders::_2)) ;
+    }
+}
+
+//======================================================================
+auto SyncChannel::waitHandler(const asio::error_code &ec) -> void {
+    if (ec) {
+        this->readHandler(ec, 0) ;
+        return ;
+    }
+    auto size = static_cast<std::size_t>(senderEndpoint.capacity()) ;
+    auto stamped = false ;
+    auto amount = KernelTimestamp::receive(udpSocket.native_handle(), receiveBuffer.data(), receiveBuffer.size(), senderEndpoint.data(), size, arrival, stamped) ;
+    if (amount < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            this->read() ;
+            return ;
+        }
+        this->readHandler(asio::error_code(errno, asio::error::get_system_category()), 0) ;
+        return ;
+    }
+    senderEndpoint.resize(size) ;
+    haveArrival = stamped ;
+    this->readHandler(asio::error_code(), static_cast<size_t>(amount)) ;
+}
+
+//======================================================================
+auto SyncChannel::readHandler(const asio::error_code &ec, size_t bytes_transferred) -> void {
+    if (ec) {
+        if (ec == asio::error::operation_aborted || !udpSocket.is_open()) {
+            return ;
+        }
+        // A udp error (icmp unreachable and the like) is not fatal, just requeue
+        this->read() ;
+        return ;
+    }
+    this->process(bytes_transferred) ;
+    this->read() ;
+}
+
+//======================================================================
+auto SyncChannel::process(size_t bytes_transferred) -> void {
+    receivedCount += 1 ;
+    if (serverAddress.is_unspecified() || senderEndpoint.address() != serverAddress) {
+        rejectedCount += 1 ;
+        return ;
+    }
+    if (bytes_transferred < static_cast<size_t>(DatagramPacket::PACKETSIZE)) {
+        rejectedCount += 1 ;
+        return ;
+    }
+    auto datagram = DatagramPacket(std::vector<std::uint8_t>(receiveBuffer.begin(),receiveBuffer.begin() + bytes_transferred)) ;
+    if (datagram.packetID() != PacketType::DATAGRAM || datagram.length() != bytes_transferred) {
+        rejectedCount += 1 ;
+        return ;
+    }
+    auto sequence = datagram.sequence() ;
+    // Use the signed difference, so we handle the sequence wrapping
+    if (haveSequence && static_cast<std::int32_t>(sequence - lastSequence) <= 0) {
+        // A duplicate, or one that was overtaken by a newer datagram
+        staleCount += 1 ;
+        return ;
+    }
+    auto payload = std::make_shared<Packet>(datagram.payload()) ;
+    if (haveArrival) {
+        payload->stamp(arrival) ;
+    }
+    if (payload->size() < static_cast<std::uint32_t>(Packet::PACKETHEADERSIZE) || payload->length() != payload->size()) {
+        rejectedCount += 1 ;
+        return ;
+    }
+    haveSequence = true ;
+    lastSequence = sequence ;
+    if (processingCallback != nullptr) {
+        processingCallback(payload) ;
+    }
+}
+
+//======================================================================
+SyncChannel::SyncChannel(asio::io_context &context):udpSocket(context),receiveBuffer(MAXDATAGRAMSIZE,0),haveSequence(false),lastSequence(0),receivedCount(0),staleCount(0),rejectedCount(0),kernelStamps(false),haveArrival(false),processingCallback(nullptr) {
+    
+}
+
+//======================================================================
+SyncChannel::~SyncChannel() {
+    this->close() ;
+}
+
+//======================================================================
+auto SyncChannel::open(std::uint16_t port) -> bool {
+    asio::error_code ec ;
+    this->close() ;
+    udpSocket.open(asio::ip::udp::v4(),ec) ;
+    if (ec) {
+        DBGMSG(std::cerr, "Unable to open sync channel: "s + ec.message());
+        return false ;
+    }
+    udpSocket.set_option(asio::socket_base::reuse_address(true),ec) ;
+    kernelStamps = KernelTimestamp::enable(udpSocket.native_handle()) ;
+    haveArrival = false ;
+    udpSocket.bind(asio::ip::udp::endpoint(asio::ip::address_v4::any(),port),ec) ;
+    if (ec) {
+        DBGMSG(std::cerr, "Unable to bind sync channel to port "s + std::to_string(port) + ": "s + ec.message());
+        udpSocket.close(ec) ;
+        return false ;
+    }
+    this->read() ;
+    return true ;
+}
+
+//======================================================================
+auto SyncChannel::close() -> void {
+    if (udpSocket.is_open()) {
+        asio::error_code ec ;
+        udpSocket.close(ec) ;
+    }
+}
+
+//======================================================================
+auto SyncChannel::is_open() const -> bool {
+    return udpSocket.is_open() ;
+}
+
+//======================================================================
+auto SyncChannel::port() const -> std::uint16_t {
+    if (!udpSocket.is_open()) {
+        return 0 ;
+    }
+    asio::error_code ec ;
+    auto endpoint = udpSocket.local_endpoint(ec) ;
+    if (ec) {
+        return 0 ;
+    }
+    return endpoint.port() ;
+}
+
+//======================================================================
+auto SyncChannel::setServer(const asio::ip::address &address) -> void {
+    // The reads are handled on the io_context thread, so make the change there
+    asio::post(udpSocket.get_executor(),[self = this->shared_from_this(),address](){
+        self->serverAddress = address ;
+        self->haveSequence = false ;
+        self->lastSequence = 0 ;
+    });
+}
+
+//======================================================================
+auto SyncChannel::setPacketRoutine(PacketProcessing function) -> void {
+    processingCallback = function ;
+}
+
+//======================================================================
+auto SyncChannel::received() const -> std::uint64_t {
+    return receivedCount ;
+}
+
+//======================================================================
+auto SyncChannel::stale() const -> std::uint64_t {
+    return staleCount ;
+}
+
+//======================================================================
+auto SyncChannel::rejected() const -> std::uint64_t {
+    return rejectedCount ;
+}
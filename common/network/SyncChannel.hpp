@@ -0,0 +1,71 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef SyncChannel_hpp
+#define SyncChannel_hpp
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "asio.hpp"
+
+#include "packets/Packet.hpp"
+
+// ==================================================================================================
+// The optional udp channel the server can use for SYNC (and frame BUFFER) datagrams, so they are
+// not held behind LOAD/BUFFER traffic on the tcp connection.  Each datagram carries a sequence
+// number, and anything that is not newer than the last one we accepted is dropped.
+// ==================================================================================================
+class SyncChannel;
+using SyncChannelPointer = std::shared_ptr<SyncChannel> ;
+
+class SyncChannel : public std::enable_shared_from_this<SyncChannel> {
+public:
+    using PacketProcessing = std::function<bool(std::shared_ptr<Packet>)> ;
+    static constexpr auto MAXDATAGRAMSIZE = 65507 ;
+private:
+    asio::ip::udp::socket udpSocket ;
+    asio::ip::udp::endpoint senderEndpoint ;
+    asio::ip::address serverAddress ;
+    std::vector<std::uint8_t> receiveBuffer ;
+    
+    bool haveSequence ;
+    std::uint32_t lastSequence ;
+    
+    std::uint64_t receivedCount ;
+    std::uint64_t staleCount ;
+    std::uint64_t rejectedCount ;
+    
+    // Kernel arrival stamps for the datagrams, when the platform has them
+    bool kernelStamps ;
+    bool haveArrival ;
+    util::ourclock::time_point arrival ;
+    
+    PacketProcessing processingCallback ;
+    
+    auto read() -> void ;
+    auto waitHandler(const asio::error_code &ec) -> void ;
+    auto readHandler(const asio::error_code &ec, size_t bytes_transferred) -> void ;
+    auto process(size_t bytes_transferred) -> void ;
+public:
+    SyncChannel(asio::io_context &context) ;
+    ~SyncChannel() ;
+    
+    auto open(std::uint16_t port) -> bool ;
+    auto close() -> void ;
+    auto is_open() const -> bool ;
+    auto port() const -> std::uint16_t ;
+    
+    // Only datagrams from the server we are connected to are accepted. Setting the
+    // server also starts a new sequence (the server may have restarted)
+    auto setServer(const asio::ip::address &address) -> void ;
+    auto setPacketRoutine(PacketProcessing function) -> void ;
+    
+    auto received() const -> std::uint64_t ;
+    auto stale() const -> std::uint64_t ;
+    auto rejected() const -> std::uint64_t ;
+};
+
+#endif /* SyncChannel_hpp */
@@ -0,0 +1,74 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "ChunkPacket.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std::string_literals ;
+
+//======================================================================
+ChunkPacket::ChunkPacket() : Packet(PacketType::CHUNK, PACKETSIZE) {
+    
+}
+
+//======================================================================
+ChunkPacket::ChunkPacket(ManifestPacket::ContentType type, std::uint64_t hash, std::uint64_t offset, const std::uint8_t *data, std::uint32_t amount) : ChunkPacket() {
+    this->setContentType(type) ;
+    this->setHash(hash) ;
+    this->setChunkOffset(offset) ;
+    this->setChunk(data, amount) ;
+}
+
+//======================================================================
+auto ChunkPacket::contentType() const -> ManifestPacket::ContentType {
+    return static_cast<ManifestPacket::ContentType>(this->read<std::uint32_t>(TYPEOFFSET)) ;
+}
+
+//======================================================================
+auto ChunkPacket::setContentType(ManifestPacket::ContentType value) -> void {
+    this->write(static_cast<std::uint32_t>(value), TYPEOFFSET) ;
+}
+
+//======================================================================
+auto ChunkPacket::hash() const -> std::uint64_t {
+    return this->read<std::uint64_t>(HASHOFFSET) ;
+}
+
+//======================================================================
+auto ChunkPacket::setHash(std::uint64_t value) -> void {
+    this->write(value, HASHOFFSET) ;
+}
+
+//======================================================================
+auto ChunkPacket::chunkOffset() const -> std::uint64_t {
+    return this->read<std::uint64_t>(OFFSETOFFSET) ;
+}
+
+//======================================================================
+auto ChunkPacket::setChunkOffset(std::uint64_t value) -> void {
+    this->write(value, OFFSETOFFSET) ;
+}
+
+//======================================================================
+auto ChunkPacket::chunk() const -> const std::uint8_t* {
+    return this->bufferData().data() + DATAOFFSET ;
+}
+
+//======================================================================
+auto ChunkPacket::chunkSize() const -> std::uint32_t {
+    auto length = std::min(this->length(),this->size()) ;
+    if (length <= DATAOFFSET) {
+        return 0 ;
+    }
+    return static_cast<std::uint32_t>(length - DATAOFFSET) ;
+}
+
+//======================================================================
+auto ChunkPacket::setChunk(const std::uint8_t *data, std::uint32_t amount) -> void {
+    this->resize(DATAOFFSET + amount) ;
+    this->setLength(static_cast<std::uint32_t>(DATAOFFSET + amount)) ;
+    if (amount > 0) {
+        std::copy(data, data + amount, this->bufferData().begin() + DATAOFFSET) ;
+    }
+}
@@ -0,0 +1,55 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef ChunkPacket_hpp
+#define ChunkPacket_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Packet.hpp"
+#include "ManifestPacket.hpp"
+
+//======================================================================
+/* *****************************************************************************
+ ChunkPacket
+ 
+ A piece of manifest content. An empty chunk short of the end means the
+ server can not supply it.
+ 
+ Name                               Type                                Offset
+ packetID                       std::uint32_t                           0
+ length                         std::uint32_t                           4
+ content type                   std::uint32_t                           8
+ hash                           std::uint64_t                           12
+ offset                         std::uint64_t                           20
+ data                           [unsigned char]                         28
+ ******************************************************************************* */
+
+class ChunkPacket : public Packet {
+    static constexpr auto TYPEOFFSET = Packet::PACKETHEADERSIZE ;
+    static constexpr auto HASHOFFSET = TYPEOFFSET + 4 ;
+    static constexpr auto OFFSETOFFSET = HASHOFFSET + 8 ;
+    static constexpr auto DATAOFFSET = OFFSETOFFSET + 8 ;
+    
+public:
+    static constexpr auto PACKETSIZE = DATAOFFSET ;
+    
+    ChunkPacket() ;
+    ChunkPacket(ManifestPacket::ContentType type, std::uint64_t hash, std::uint64_t offset, const std::uint8_t *data, std::uint32_t amount) ;
+    
+    auto contentType() const -> ManifestPacket::ContentType ;
+    auto setContentType(ManifestPacket::ContentType value) -> void ;
+    auto hash() const -> std::uint64_t ;
+    auto setHash(std::uint64_t value) -> void ;
+    auto chunkOffset() const -> std::uint64_t ;
+    auto setChunkOffset(std::uint64_t value) -> void ;
+    
+    // The chunk data, in place
+    auto chunk() const -> const std::uint8_t* ;
+    auto chunkSize() const -> std::uint32_t ;
+    auto setChunk(const std::uint8_t *data, std::uint32_t amount) -> void ;
+};
+
+#endif /* ChunkPacket_hpp */
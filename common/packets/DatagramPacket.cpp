@@ -0,0 +1,67 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "DatagramPacket.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace std::string_literals ;
+
+//======================================================================
+DatagramPacket::DatagramPacket() : Packet(PacketType::DATAGRAM, DatagramPacket::PACKETSIZE) {
+    
+}
+
+//======================================================================
+DatagramPacket::DatagramPacket(const std::vector<std::uint8_t> &data) : Packet(data) {
+    
+}
+
+//======================================================================
+DatagramPacket::DatagramPacket(std::uint32_t sequence, const Packet &payload) : DatagramPacket() {
+    this->setSequence(sequence) ;
+    this->setPayload(payload) ;
+    this->stampSendTime() ;
+}
+
+//======================================================================
+auto DatagramPacket::sequence() const -> std::uint32_t {
+    return this->read<std::uint32_t>(SEQUENCEOFFSET) ;
+}
+
+//======================================================================
+auto DatagramPacket::setSequence(std::uint32_t value) -> void {
+    this->write(value,SEQUENCEOFFSET) ;
+}
+
+//======================================================================
+auto DatagramPacket::sendTime() const -> std::int64_t {
+    return this->read<std::int64_t>(SENDTIMEOFFSET) ;
+}
+
+//======================================================================
+auto DatagramPacket::setSendTime(std::int64_t value) -> void {
+    this->write(value,SENDTIMEOFFSET) ;
+}
+
+//======================================================================
+auto DatagramPacket::stampSendTime() -> void {
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(util::ourclock::now().time_since_epoch()).count() ;
+    this->setSendTime(static_cast<std::int64_t>(now)) ;
+}
+
+//======================================================================
+auto DatagramPacket::payload() const -> std::vector<std::uint8_t> {
+    auto length = std::min(this->length(),this->size()) ;
+    if (length <= PAYLOADOFFSET) {
+        return std::vector<std::uint8_t>() ;
+    }
+    return std::vector<std::uint8_t>(this->bufferData().begin() + PAYLOADOFFSET, this->bufferData().begin() + length) ;
+}
+
+//======================================================================
+auto DatagramPacket::setPayload(const Packet &packet) -> void {
+    this->resize(PAYLOADOFFSET + packet.size()) ;
+    this->setLength(static_cast<std::uint32_t>(PAYLOADOFFSET + packet.size())) ;
+    std::copy(packet.bufferData().begin(), packet.bufferData().end(), this->bufferData().begin() + PAYLOADOFFSET) ;
+}
@@ -0,0 +1,52 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef DatagramPacket_hpp
+#define DatagramPacket_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Packet.hpp"
+
+//======================================================================
+/* *****************************************************************************
+ DatagramPacket
+ 
+ Wraps a packet (SYNC, BUFFER) that is sent over the udp sync channel.
+ The sequence is incremented by the sender for every datagram, and the
+ send time is the sender's clock in microseconds since the epoch.
+ 
+ Name                               Type                                Offset
+ packetID                       std::uint32_t                           0
+ length                         std::uint32_t                           4
+ sequence                       std::uint32_t                           8
+ sendTime                       std::int64_t                            12
+ payload                        [Packet]                                20
+ ******************************************************************************* */
+
+class DatagramPacket : public Packet {
+    static constexpr auto SEQUENCEOFFSET = Packet::PACKETHEADERSIZE ;
+    static constexpr auto SENDTIMEOFFSET = SEQUENCEOFFSET + 4 ;
+    static constexpr auto PAYLOADOFFSET = SENDTIMEOFFSET + 8 ;
+    
+public:
+    static constexpr auto PACKETSIZE = PAYLOADOFFSET ;
+    
+    DatagramPacket() ;
+    DatagramPacket(const std::vector<std::uint8_t> &data) ;
+    DatagramPacket(std::uint32_t sequence, const Packet &payload) ;
+    
+    auto sequence() const -> std::uint32_t ;
+    auto setSequence(std::uint32_t value) -> void ;
+    
+    auto sendTime() const -> std::int64_t ;
+    auto setSendTime(std::int64_t value) -> void ;
+    auto stampSendTime() -> void ;
+    
+    auto payload() const -> std::vector<std::uint8_t> ;
+    auto setPayload(const Packet &packet) -> void ;
+};
+
+#endif /* DatagramPacket_hpp */
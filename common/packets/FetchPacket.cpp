@@ -0,0 +1,61 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "FetchPacket.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std::string_literals ;
+
+//======================================================================
+FetchPacket::FetchPacket() : Packet(PacketType::FETCH, PACKETSIZE) {
+    
+}
+
+//======================================================================
+FetchPacket::FetchPacket(ManifestPacket::ContentType type, std::uint64_t hash, std::uint64_t offset, std::uint32_t amount) : FetchPacket() {
+    this->setContentType(type) ;
+    this->setHash(hash) ;
+    this->setFetchOffset(offset) ;
+    this->setAmount(amount) ;
+}
+
+//======================================================================
+auto FetchPacket::contentType() const -> ManifestPacket::ContentType {
+    return static_cast<ManifestPacket::ContentType>(this->read<std::uint32_t>(TYPEOFFSET)) ;
+}
+
+//======================================================================
+auto FetchPacket::setContentType(ManifestPacket::ContentType value) -> void {
+    this->write(static_cast<std::uint32_t>(value), TYPEOFFSET) ;
+}
+
+//======================================================================
+auto FetchPacket::hash() const -> std::uint64_t {
+    return this->read<std::uint64_t>(HASHOFFSET) ;
+}
+
+//======================================================================
+auto FetchPacket::setHash(std::uint64_t value) -> void {
+    this->write(value, HASHOFFSET) ;
+}
+
+//======================================================================
+auto FetchPacket::fetchOffset() const -> std::uint64_t {
+    return this->read<std::uint64_t>(OFFSETOFFSET) ;
+}
+
+//======================================================================
+auto FetchPacket::setFetchOffset(std::uint64_t value) -> void {
+    this->write(value, OFFSETOFFSET) ;
+}
+
+//======================================================================
+auto FetchPacket::amount() const -> std::uint32_t {
+    return this->read<std::uint32_t>(AMOUNTOFFSET) ;
+}
+
+//======================================================================
+auto FetchPacket::setAmount(std::uint32_t value) -> void {
+    this->write(value, AMOUNTOFFSET) ;
+}
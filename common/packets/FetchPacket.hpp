@@ -0,0 +1,50 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef FetchPacket_hpp
+#define FetchPacket_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "Packet.hpp"
+#include "ManifestPacket.hpp"
+
+//======================================================================
+/* *****************************************************************************
+ FetchPacket
+ 
+ A client asking for a piece of manifest content, answered with a CHUNK
+ 
+ Name                               Type                                Offset
+ packetID                       std::uint32_t                           0
+ length                         std::uint32_t                           4
+ content type                   std::uint32_t                           8
+ hash                           std::uint64_t                           12
+ offset                         std::uint64_t                           20
+ amount                         std::uint32_t                           28
+ ******************************************************************************* */
+
+class FetchPacket : public Packet {
+    static constexpr auto TYPEOFFSET = Packet::PACKETHEADERSIZE ;
+    static constexpr auto HASHOFFSET = TYPEOFFSET + 4 ;
+    static constexpr auto OFFSETOFFSET = HASHOFFSET + 8 ;
+    static constexpr auto AMOUNTOFFSET = OFFSETOFFSET + 8 ;
+    
+public:
+    static constexpr auto PACKETSIZE = AMOUNTOFFSET + 4 ;
+    
+    FetchPacket() ;
+    FetchPacket(ManifestPacket::ContentType type, std::uint64_t hash, std::uint64_t offset, std::uint32_t amount) ;
+    
+    auto contentType() const -> ManifestPacket::ContentType ;
+    auto setContentType(ManifestPacket::ContentType value) -> void ;
+    auto hash() const -> std::uint64_t ;
+    auto setHash(std::uint64_t value) -> void ;
+    auto fetchOffset() const -> std::uint64_t ;
+    auto setFetchOffset(std::uint64_t value) -> void ;
+    auto amount() const -> std::uint32_t ;
+    auto setAmount(std::uint32_t value) -> void ;
+};
+
+#endif /* FetchPacket_hpp */
@@ -15,8 +15,10 @@ IdentPacket::IdentPacket():Packet(PacketType::IDENT, IdentPacket::PACKETSIZE) {
 }
 
 //======================================================================
-IdentPacket::IdentPacket(const std::string &handle):IdentPacket() {
+IdentPacket::IdentPacket(const std::string &handle, std::uint16_t syncport, std::uint32_t capabilities):IdentPacket() {
     this->setHandle(handle);
+    this->setSyncPort(syncport);
+    this->setCapabilities(capabilities);
 }
 
 //======================================================================
@@ -28,3 +30,31 @@ auto IdentPacket::handle() const -> std::string {
 auto IdentPacket::setHandle(const std::string &value) -> void {
     this->write(value,HANDLESIZE,HANDLEOFFSET);
 }
+
+//======================================================================
+auto IdentPacket::syncPort() const -> std::uint16_t {
+    if (this->size() < CAPABILITIESOFFSET) {
+        // An older ident, that did not have a sync port
+        return 0 ;
+    }
+    return static_cast<std::uint16_t>(this->read<std::uint32_t>(SYNCPORTOFFSET)) ;
+}
+
+//======================================================================
+auto IdentPacket::setSyncPort(std::uint16_t value) -> void {
+    this->write(static_cast<std::uint32_t>(value),SYNCPORTOFFSET);
+}
+
+//======================================================================
+auto IdentPacket::capabilities() const -> std::uint32_t {
+    if (this->size() < PACKETSIZE) {
+        // An older ident, it only understands the base packets
+        return NONE ;
+    }
+    return this->read<std::uint32_t>(CAPABILITIESOFFSET) ;
+}
+
+//======================================================================
+auto IdentPacket::setCapabilities(std::uint32_t value) -> void {
+    this->write(value,CAPABILITIESOFFSET);
+}
@@ -17,17 +17,32 @@
  packetID                       std::uint32_t                           0
  length                         std::uint32_t                           4
  handle                         char[30]                                8
+ syncPort                       std::uint32_t                           38
+ capabilities                   std::uint32_t                           42
+ 
+ syncPort is the udp port the client listens on for DATAGRAM packets (0 if none)
+ capabilities is a mask of the optional packets the client understands
  ******************************************************************************* */
 class IdentPacket : public Packet {
     static constexpr auto HANDLEOFFSET = Packet::PACKETHEADERSIZE ;
     static constexpr auto HANDLESIZE = 30 ;
+    static constexpr auto SYNCPORTOFFSET = HANDLEOFFSET + HANDLESIZE ;
+    static constexpr auto CAPABILITIESOFFSET = SYNCPORTOFFSET + 4 ;
 public:
-    static constexpr auto PACKETSIZE = HANDLEOFFSET + HANDLESIZE ;
+    static constexpr auto PACKETSIZE = CAPABILITIESOFFSET + 4 ;
+    
+    enum Capability : std::uint32_t {
+        NONE = 0, ZBUFFER = 0x1
+    };
 
     IdentPacket() ;
-    IdentPacket(const std::string &handle);
+    IdentPacket(const std::string &handle, std::uint16_t syncport = 0, std::uint32_t capabilities = 0);
     auto handle() const -> std::string ;
     auto setHandle(const std::string &value) -> void ;
+    auto syncPort() const -> std::uint16_t ;
+    auto setSyncPort(std::uint16_t value) -> void ;
+    auto capabilities() const -> std::uint32_t ;
+    auto setCapabilities(std::uint32_t value) -> void ;
 };
 
 #endif /* IdentPacket_hpp */
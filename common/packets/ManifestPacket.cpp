@@ -0,0 +1,63 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "ManifestPacket.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std::string_literals ;
+
+//======================================================================
+ManifestPacket::ManifestPacket() : Packet(PacketType::MANIFEST, PACKETSIZE) {
+    
+}
+
+//======================================================================
+ManifestPacket::ManifestPacket(const std::vector<Entry> &entries) : ManifestPacket() {
+    this->setEntries(entries) ;
+}
+
+//======================================================================
+auto ManifestPacket::count() const -> std::uint32_t {
+    auto length = std::min(this->length(),this->size()) ;
+    if (length < ENTRYOFFSET) {
+        return 0 ;
+    }
+    // Never trust the count past what actually arrived
+    auto count = this->read<std::uint32_t>(COUNTOFFSET) ;
+    auto room = static_cast<std::uint32_t>((length - ENTRYOFFSET) / ENTRYSIZE) ;
+    return std::min(count, room) ;
+}
+
+//======================================================================
+auto ManifestPacket::entries() const -> std::vector<Entry> {
+    auto entries = std::vector<Entry>() ;
+    auto count = this->count() ;
+    entries.reserve(count) ;
+    for (std::uint32_t index = 0 ; index < count ; index++) {
+        auto offset = ENTRYOFFSET + (index * ENTRYSIZE) ;
+        auto entry = Entry() ;
+        entry.type = static_cast<ContentType>(this->read<std::uint32_t>(offset)) ;
+        entry.size = this->read<std::uint64_t>(offset + 4) ;
+        entry.hash = this->read<std::uint64_t>(offset + 12) ;
+        entry.name = this->read<std::string>(NAMESIZE, offset + 20) ;
+        entries.push_back(entry) ;
+    }
+    return entries ;
+}
+
+//======================================================================
+auto ManifestPacket::setEntries(const std::vector<Entry> &entries) -> void {
+    auto size = ENTRYOFFSET + (static_cast<int>(entries.size()) * ENTRYSIZE) ;
+    this->resize(size) ;
+    this->setLength(static_cast<std::uint32_t>(size)) ;
+    this->write(static_cast<std::uint32_t>(entries.size()), COUNTOFFSET) ;
+    auto offset = ENTRYOFFSET ;
+    for (const auto &entry : entries) {
+        this->write(static_cast<std::uint32_t>(entry.type), offset) ;
+        this->write(entry.size, offset + 4) ;
+        this->write(entry.hash, offset + 12) ;
+        this->write(entry.name, NAMESIZE, offset + 20) ;
+        offset += ENTRYSIZE ;
+    }
+}
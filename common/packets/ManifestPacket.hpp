@@ -0,0 +1,60 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef ManifestPacket_hpp
+#define ManifestPacket_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Packet.hpp"
+
+//======================================================================
+/* *****************************************************************************
+ ManifestPacket
+ 
+ The content the server wants each client to have
+ 
+ Name                               Type                                Offset
+ packetID                       std::uint32_t                           0
+ length                         std::uint32_t                           4
+ entry count                    std::uint32_t                           8
+ entries                        [entry]                                 12
+ 
+ Entry
+ content type                   std::uint32_t                           0
+ size                           std::uint64_t                           4
+ hash (fnv-1a 64)               std::uint64_t                           12
+ name (no extension)            char[30]                                20
+ ******************************************************************************* */
+
+class ManifestPacket : public Packet {
+public:
+    enum ContentType : std::uint32_t {
+        MUSIC = 0, LIGHT
+    };
+    struct Entry {
+        ContentType type ;
+        std::uint64_t size ;
+        std::uint64_t hash ;
+        std::string name ;
+    };
+private:
+    static constexpr auto COUNTOFFSET = Packet::PACKETHEADERSIZE ;
+    static constexpr auto ENTRYOFFSET = COUNTOFFSET + 4 ;
+    static constexpr auto NAMESIZE = 30 ;
+    static constexpr auto ENTRYSIZE = 20 + NAMESIZE ;
+    
+public:
+    static constexpr auto PACKETSIZE = ENTRYOFFSET ;
+    
+    ManifestPacket() ;
+    ManifestPacket(const std::vector<Entry> &entries) ;
+    
+    auto count() const -> std::uint32_t ;
+    auto entries() const -> std::vector<Entry> ;
+    auto setEntries(const std::vector<Entry> &entries) -> void ;
+};
+
+#endif /* ManifestPacket_hpp */
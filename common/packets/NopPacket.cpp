@@ -4,13 +4,15 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include <chrono>
 
 
 using namespace std::string_literals ;
 
 //======================================================================
 NopPacket::NopPacket() :Packet(PacketType::NOP, PACKETSIZE){
-    
+    this->setOriginTime(std::chrono::duration_cast<std::chrono::microseconds>(util::ourclock::now().time_since_epoch()).count()) ;
+    this->setDelay(-1) ;
 }
 
 //======================================================================
@@ -26,3 +28,39 @@ auto NopPacket::respond() const -> bool {
 auto NopPacket::setRespond(bool value) -> void {
     this->write( (value ? std::uint32_t(1) : std::uint32_t(0)) ,RESPONDOFFSET);
 }
+
+//======================================================================
+auto NopPacket::originTime() const -> std::int64_t {
+    if (this->size() < PACKETSIZE) {
+        return 0 ;
+    }
+    return this->read<std::int64_t>(ORIGINOFFSET) ;
+}
+//======================================================================
+auto NopPacket::setOriginTime(std::int64_t value) -> void {
+    this->write(value,ORIGINOFFSET);
+}
+
+//======================================================================
+auto NopPacket::echoTime() const -> std::int64_t {
+    if (this->size() < PACKETSIZE) {
+        return 0 ;
+    }
+    return this->read<std::int64_t>(ECHOOFFSET) ;
+}
+//======================================================================
+auto NopPacket::setEchoTime(std::int64_t value) -> void {
+    this->write(value,ECHOOFFSET);
+}
+
+//======================================================================
+auto NopPacket::delay() const -> std::int32_t {
+    if (this->size() < PACKETSIZE) {
+        return -1 ;
+    }
+    return this->read<std::int32_t>(DELAYOFFSET) ;
+}
+//======================================================================
+auto NopPacket::setDelay(std::int32_t value) -> void {
+    this->write(value,DELAYOFFSET);
+}
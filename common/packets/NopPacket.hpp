@@ -16,21 +16,39 @@
  packetID                       std::uint32_t                           0
  length                         std::uint32_t                           4
  respond                        std::uint32_t                           8
+ originTime                     std::int64_t                            12
+ echoTime                       std::int64_t                            20
+ delay                          std::int32_t                            28
+ 
+ Times are microseconds since the epoch on the sender's clock. A reply copies the
+ originTime of the nop it answers into echoTime, so the sender can measure the round
+ trip. delay is the sender's current one way delay estimate in microseconds (-1 unknown).
+ Older nops only have the respond field, the other fields then read as 0 (delay -1).
  ******************************************************************************* */
 
 //======================================================================
 class NopPacket : public Packet {
     
     static constexpr auto RESPONDOFFSET = Packet::PACKETHEADERSIZE ;
+    static constexpr auto ORIGINOFFSET = RESPONDOFFSET + 4 ;
+    static constexpr auto ECHOOFFSET = ORIGINOFFSET + 8 ;
+    static constexpr auto DELAYOFFSET = ECHOOFFSET + 8 ;
     
 public:
-    static constexpr auto PACKETSIZE = RESPONDOFFSET + 4 ;
+    static constexpr auto PACKETSIZE = DELAYOFFSET + 4 ;
     
     NopPacket() ;
     NopPacket(bool respond) ;
     
     auto respond() const -> bool ;
     auto setRespond(bool value) -> void ;
+    
+    auto originTime() const -> std::int64_t ;
+    auto setOriginTime(std::int64_t value) -> void ;
+    auto echoTime() const -> std::int64_t ;
+    auto setEchoTime(std::int64_t value) -> void ;
+    auto delay() const -> std::int32_t ;
+    auto setDelay(std::int32_t value) -> void ;
 };
 
 #endif /* NopPacket_hpp */
@@ -9,7 +9,7 @@
 using namespace std::string_literals ;
 
 // ==========================================================================================
-Packet::Packet() : util::Buffer() {
+Packet::Packet() : util::Buffer(),stampDelay(-1) {
     this->setExtend(true);
     this->setOffset(0);
     this->timeStamp = util::ourclock::now() ;
@@ -69,6 +69,14 @@ auto Packet::type() const -> const std::string & {
     return PacketType::nameForPacket(this->packetID()) ;
 }
 
+// ==========================================================================================
+auto Packet::lengthFromHeader(const std::uint8_t *header) -> std::uint32_t {
+    // Same byte order as Buffer::read
+    auto length = std::uint32_t(0) ;
+    std::reverse_copy(header + PACKETLENGTHOFFSET, header + PACKETLENGTHOFFSET + 4, reinterpret_cast<std::uint8_t*>(&length)) ;
+    return length ;
+}
+
 // This returns the "length" of the packet, according to data in the packet
 // ==========================================================================================
 auto Packet::length() const -> std::uint32_t {
@@ -85,6 +93,23 @@ auto Packet::setLength(std::uint32_t length) -> void {
 // ==========================================================================================
 auto Packet::stamp() -> void {
     timeStamp = util::ourclock::now() ;
+    stampDelay = std::chrono::microseconds(-1) ;
+}
+
+// ==========================================================================================
+auto Packet::stamp(const util::ourclock::time_point &arrival) -> void {
+    auto now = util::ourclock::now() ;
+    timeStamp = arrival ;
+    stampDelay = std::max(std::chrono::duration_cast<std::chrono::microseconds>(now - arrival), std::chrono::microseconds(0)) ;
+}
+
+// ==========================================================================================
+auto Packet::stampGap() const -> std::chrono::microseconds {
+    return stampDelay ;
+}
+// ==========================================================================================
+auto Packet::time() const -> const util::ourclock::time_point& {
+    return timeStamp ;
 }
 // ==========================================================================================
 auto Packet::millisecondsSince(const util::ourclock::time_point &now) -> size_t{
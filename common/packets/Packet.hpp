@@ -3,6 +3,7 @@
 #ifndef Packet_hpp
 #define Packet_hpp
 
+#include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <string>
@@ -26,6 +27,7 @@
 class Packet : public util::Buffer {
     static constexpr auto PACKETLENGTHOFFSET = 4 ;
     util::ourclock::time_point timeStamp;
+    std::chrono::microseconds stampDelay ;
 public:
     static constexpr auto PACKETHEADERSIZE = std::int32_t(8) ;
 
@@ -45,12 +47,20 @@ public:
     auto setPacketID(PacketType::PacketID packID) -> void ;
     auto type() const -> const std::string & ;
     
+    // The length from the header of a packet still in a raw byte stream (at least PACKETHEADERSIZE bytes)
+    static auto lengthFromHeader(const std::uint8_t *header) -> std::uint32_t ;
+    
     // This returns the "length" of the packet, according to data in the packet
     auto length() const -> std::uint32_t ;
     auto setLength(std::uint32_t length) -> void ;
     
     // An ability to timestamp packets
     auto stamp() -> void ;
+    // Stamp with when the data actually arrived (the kernel receive time), remembering how far
+    // behind that we got to it. The gap is negative for packets stamped in userspace
+    auto stamp(const util::ourclock::time_point &arrival) -> void ;
+    auto stampGap() const -> std::chrono::microseconds ;
+    auto time() const -> const util::ourclock::time_point& ;
     auto millisecondsSince(const util::ourclock::time_point &now) -> size_t ;
     
 };
@@ -14,9 +14,10 @@ PlayPacket::PlayPacket() : Packet(PacketType::PLAY, PACKETSIZE){
 }
 
 //======================================================================
-PlayPacket::PlayPacket(bool state, std::int32_t frame):PlayPacket() {
+PlayPacket::PlayPacket(bool state, std::int32_t frame, std::int64_t starttime):PlayPacket() {
     this->setState(state) ;
     this->setFrame(frame) ;
+    this->setStartTime(starttime) ;
 }
 
 
@@ -43,3 +44,16 @@ auto PlayPacket::setFrame(std::int32_t value) -> void {
 
 }
 
+//======================================================================
+auto PlayPacket::startTime() const -> std::int64_t {
+    if (this->size() < PACKETSIZE) {
+        // An older play, start on arrival
+        return 0 ;
+    }
+    return this->read<std::int64_t>(STARTOFFSET) ;
+}
+
+//======================================================================
+auto PlayPacket::setStartTime(std::int64_t value) -> void {
+    this->write(value, STARTOFFSET) ;
+}
@@ -18,24 +18,32 @@
  length                         std::uint32_t                           4
  state                          std::uint32_t                           8
  frame                          std::int32_t                            12
+ startTime                      std::int64_t                            16
+ 
+ startTime is when (microseconds since the epoch, system clock) frame should
+ begin, 0 to begin as soon as it arrives
  ******************************************************************************* */
 class PlayPacket : public Packet {
     
     static constexpr auto STATEOFFSET = Packet::PACKETHEADERSIZE ;
     static constexpr auto FRAMEOFFSET = STATEOFFSET + 4 ;
+    static constexpr auto STARTOFFSET = FRAMEOFFSET + 4 ;
     
 public:
 
-    static constexpr auto PACKETSIZE = FRAMEOFFSET + 4 ;
+    static constexpr auto PACKETSIZE = STARTOFFSET + 8 ;
     
     PlayPacket() ;
-    PlayPacket(bool state, std::int32_t frame = 0);
+    PlayPacket(bool state, std::int32_t frame = 0, std::int64_t starttime = 0);
     
     auto state() const -> bool ;
     auto setState(bool value) -> void ;
     
     auto frame() const -> std::int32_t ;
     auto setFrame(std::int32_t value) -> void ;
+    
+    auto startTime() const -> std::int64_t ;
+    auto setStartTime(std::int64_t value) -> void ;
 };
 
 #endif /* PlayPacket_hpp */
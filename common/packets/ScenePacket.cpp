@@ -0,0 +1,39 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "ScenePacket.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std::string_literals ;
+
+//======================================================================
+ScenePacket::ScenePacket() : Packet(PacketType::SCENE, PACKETSIZE) {
+    
+}
+
+//======================================================================
+ScenePacket::ScenePacket(std::uint64_t hash, bool miss) : ScenePacket() {
+    this->setHash(hash) ;
+    this->setMiss(miss) ;
+}
+
+//======================================================================
+auto ScenePacket::hash() const -> std::uint64_t {
+    return this->read<std::uint64_t>(HASHOFFSET) ;
+}
+
+//======================================================================
+auto ScenePacket::setHash(std::uint64_t value) -> void {
+    this->write(value, HASHOFFSET) ;
+}
+
+//======================================================================
+auto ScenePacket::miss() const -> bool {
+    return this->read<std::uint32_t>(MISSOFFSET) != 0 ;
+}
+
+//======================================================================
+auto ScenePacket::setMiss(bool value) -> void {
+    this->write(static_cast<std::uint32_t>(value ? 1 : 0), MISSOFFSET) ;
+}
@@ -0,0 +1,43 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef ScenePacket_hpp
+#define ScenePacket_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "Packet.hpp"
+
+//======================================================================
+/* *****************************************************************************
+ ScenePacket
+ 
+ From the server: apply the buffer we already have whose content hash
+ (fnv-1a 64 of the decoded buffer) is given. A client that does not have it
+ sends it back with miss set, and the server falls back to a BUFFER.
+ 
+ Name                               Type                                Offset
+ packetID                       std::uint32_t                           0
+ length                         std::uint32_t                           4
+ hash                           std::uint64_t                           8
+ miss                           std::uint32_t                           16
+ ******************************************************************************* */
+
+class ScenePacket : public Packet {
+    static constexpr auto HASHOFFSET = Packet::PACKETHEADERSIZE ;
+    static constexpr auto MISSOFFSET = HASHOFFSET + 8 ;
+    
+public:
+    static constexpr auto PACKETSIZE = MISSOFFSET + 4 ;
+    
+    ScenePacket() ;
+    ScenePacket(std::uint64_t hash, bool miss = false) ;
+    
+    auto hash() const -> std::uint64_t ;
+    auto setHash(std::uint64_t value) -> void ;
+    auto miss() const -> bool ;
+    auto setMiss(bool value) -> void ;
+};
+
+#endif /* ScenePacket_hpp */
@@ -0,0 +1,27 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "StatsPacket.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std::string_literals ;
+
+//======================================================================
+StatsPacket::StatsPacket() : Packet(PacketType::STATS, PACKETSIZE) {
+    
+}
+
+//======================================================================
+auto StatsPacket::value(Field field) const -> std::uint32_t {
+    auto offset = FIELDOFFSET + (4 * static_cast<int>(field)) ;
+    if (offset + 4 > static_cast<int>(this->size())) {
+        return 0 ;
+    }
+    return this->read<std::uint32_t>(offset) ;
+}
+
+//======================================================================
+auto StatsPacket::setValue(Field field, std::uint32_t value) -> void {
+    this->write(value, FIELDOFFSET + (4 * static_cast<int>(field))) ;
+}
@@ -0,0 +1,100 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef StatsPacket_hpp
+#define StatsPacket_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "Packet.hpp"
+
+//======================================================================
+/* *****************************************************************************
+ StatsPacket
+ 
+ Periodic health report from a client, covering the time since the last one
+ 
+ Name                               Type                                Offset
+ packetID                       std::uint32_t                           0
+ length                         std::uint32_t                           4
+ interval (ms)                  std::uint32_t                           8
+ light ticks                    std::uint32_t                           12
+ tick lateness p50 (us)         std::uint32_t                           16
+ tick lateness p95 (us)         std::uint32_t                           20
+ tick lateness p99 (us)         std::uint32_t                           24
+ tick lateness max (us)         std::uint32_t                           28
+ frames dropped                 std::uint32_t                           32
+ audio underruns                std::uint32_t                           36
+ sync corrections               std::uint32_t                           40
+ sync correction total (frames) std::uint32_t                           44
+ sync correction max (frames)   std::uint32_t                           48
+ loads                          std::uint32_t                           52
+ load max (ms)                  std::uint32_t                           56
+ rss (KB)                       std::uint32_t                           60
+ cpu (0.1%)                     std::uint32_t                           64
+ network delay (us)             std::int32_t                            68
+ zbuffers decoded               std::uint32_t                           72
+ zbuffer ratio (x100)           std::uint32_t                           76
+ zbuffer decode avg (us)        std::uint32_t                           80
+ zbuffer decode max (us)        std::uint32_t                           84
+ scene hits                     std::uint32_t                           88
+ scene misses                   std::uint32_t                           92
+ light start landing (us)       std::int32_t                            96
+ audio start landing (us)       std::int32_t                            100
+ clock error (us)               std::int32_t                            104
+ start skew (us)                std::int32_t                            108
+ sync receive gap avg (us)      std::uint32_t                           112
+ sync receive gap max (us)      std::uint32_t                           116
+e1.31 bridge frames            std::uint32_t                           120
+e1.31 bridge latency avg (us)  std::uint32_t                           124
+e1.31 bridge latency max (us)  std::uint32_t                           128
+e1.31 packets lost             std::uint32_t                           132
+audio drift (us)               std::int32_t                            136
+audio drift max (us)           std::uint32_t                           140
+light sync offset (us)         std::int32_t                            144
+audio sync offset (us)         std::int32_t                            148
+light clock drift (ppm)        std::int32_t                            152
+audio clock drift (ppm)        std::int32_t                            156
+ 
+ The landings are for the most recent start: how far the first frame/sample
+ went out from when it should have. The clock error is the kernel's estimate
+ (-1 when the clock is not synchronized). The start skew is audio landing less
+ light landing for the last start that used both. The receive gap is how long
+ after the kernel took a SYNC off the wire we stamped it (only where the kernel
+ gives us the arrival time). The bridge latency is from the kernel taking the
+ first E1.31 packet of a frame off the wire to the frame being written out.
+ The audio drift is where the audio playback is against the light timer, at
+ the last tick of the interval (positive is the audio ahead), and the largest
+ either way. The sync offsets are how far ahead of the server each output was at
+ the last SYNC, and the clock drifts how fast the sync loop thinks each runs.
+ ******************************************************************************* */
+
+class StatsPacket : public Packet {
+public:
+    enum Field {
+        INTERVAL = 0, TICKS, LATENESS50, LATENESS95, LATENESS99, LATENESSMAX,
+        DROPPED, UNDERRUNS, SYNCCOUNT, SYNCTOTAL, SYNCMAX,
+        LOADS, LOADMAX, RSS, CPU, DELAY,
+        ZBUFFERS, ZRATIO, ZDECODEAVG, ZDECODEMAX,
+        SCENEHITS, SCENEMISSES,
+        LIGHTLANDING, AUDIOLANDING, CLOCKERROR, STARTSKEW,
+        RXGAPAVG, RXGAPMAX,
+        BRIDGEFRAMES, BRIDGELATAVG, BRIDGELATMAX, BRIDGELOST,
+        AVDRIFT, AVDRIFTMAX,
+        LIGHTOFFSET, AUDIOOFFSET, LIGHTDRIFT, AUDIODRIFT,
+        FIELDCOUNT
+    };
+private:
+    static constexpr auto FIELDOFFSET = Packet::PACKETHEADERSIZE ;
+public:
+    static constexpr auto PACKETSIZE = FIELDOFFSET + (4 * FIELDCOUNT) ;
+    
+    StatsPacket() ;
+    
+    // Fields a sender did not include (an older client) read as 0
+    auto value(Field field) const -> std::uint32_t ;
+    auto setValue(Field field, std::uint32_t value) -> void ;
+};
+
+#endif /* StatsPacket_hpp */
@@ -0,0 +1,67 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "ZBufferPacket.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "utility/rlecodec.hpp"
+
+using namespace std::string_literals ;
+
+//======================================================================
+ZBufferPacket::ZBufferPacket() : Packet(PacketType::ZBUFFER, PACKETSIZE) {
+    
+}
+
+//======================================================================
+ZBufferPacket::ZBufferPacket(const std::vector<std::uint8_t> &data, const std::vector<std::uint8_t> &previous) : ZBufferPacket() {
+    auto delta = !previous.empty() && previous.size() == data.size() ;
+    auto coded = util::RleCodec::encode(data.data(), data.size(), delta ? previous.data() : nullptr) ;
+    this->resize(DATAOFFSET + static_cast<std::int64_t>(coded.size())) ;
+    this->setLength(static_cast<std::uint32_t>(DATAOFFSET + coded.size())) ;
+    this->write(static_cast<std::uint32_t>(delta ? RLEDELTA : RLE), ENCODINGOFFSET) ;
+    this->write(static_cast<std::uint32_t>(data.size()), SIZEOFFSET) ;
+    std::copy(coded.begin(), coded.end(), this->bufferData().begin() + DATAOFFSET) ;
+}
+
+//======================================================================
+auto ZBufferPacket::encoding() const -> Encoding {
+    return static_cast<Encoding>(this->read<std::uint32_t>(ENCODINGOFFSET)) ;
+}
+
+//======================================================================
+auto ZBufferPacket::decodedSize() const -> std::uint32_t {
+    return this->read<std::uint32_t>(SIZEOFFSET) ;
+}
+
+//======================================================================
+auto ZBufferPacket::encoded() const -> const std::uint8_t* {
+    return this->bufferData().data() + DATAOFFSET ;
+}
+
+//======================================================================
+auto ZBufferPacket::encodedSize() const -> std::uint32_t {
+    auto length = std::min(this->length(),this->size()) ;
+    if (length <= DATAOFFSET) {
+        return 0 ;
+    }
+    return static_cast<std::uint32_t>(length - DATAOFFSET) ;
+}
+
+//======================================================================
+auto ZBufferPacket::decode(std::vector<std::uint8_t> &output) const -> bool {
+    auto delta = this->encoding() == RLEDELTA ;
+    auto size = static_cast<size_t>(this->decodedSize()) ;
+    if (size > MAXDECODEDSIZE) {
+        return false ;
+    }
+    if (delta && output.size() != size) {
+        // Nothing (or the wrong thing) to apply it to
+        return false ;
+    }
+    if (!delta) {
+        output.resize(size) ;
+    }
+    return util::RleCodec::decode(this->encoded(), this->encodedSize(), output.data(), size, delta) ;
+}
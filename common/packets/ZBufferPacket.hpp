@@ -0,0 +1,57 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef ZBufferPacket_hpp
+#define ZBufferPacket_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Packet.hpp"
+
+//======================================================================
+/* *****************************************************************************
+ ZBufferPacket
+ 
+ A BUFFER with the data run length coded (util::RleCodec), only sent to a
+ client that listed IdentPacket::ZBUFFER in its capabilities
+ 
+ Name                               Type                                Offset
+ packetID                       std::uint32_t                           0
+ length                         std::uint32_t                           4
+ encoding                       std::uint32_t                           8
+ decoded size                   std::uint32_t                           12
+ encoded data                   [unsigned char]                         16
+ ******************************************************************************* */
+
+class ZBufferPacket : public Packet {
+public:
+    enum Encoding : std::uint32_t {
+        RLE = 0,        // stands on its own
+        RLEDELTA        // XORed against the previous buffer before coding
+    };
+private:
+    static constexpr auto ENCODINGOFFSET = Packet::PACKETHEADERSIZE ;
+    static constexpr auto SIZEOFFSET = ENCODINGOFFSET + 4 ;
+    static constexpr auto DATAOFFSET = SIZEOFFSET + 4 ;
+    
+public:
+    static constexpr auto PACKETSIZE = DATAOFFSET ;
+    // Larger than any pair of pru buffers, so a bad size can not make us allocate the world
+    static constexpr auto MAXDECODEDSIZE = 262144 ;
+    
+    ZBufferPacket() ;
+    // Encodes data, against previous if it is the same size
+    ZBufferPacket(const std::vector<std::uint8_t> &data, const std::vector<std::uint8_t> &previous = std::vector<std::uint8_t>()) ;
+    
+    auto encoding() const -> Encoding ;
+    auto decodedSize() const -> std::uint32_t ;
+    auto encoded() const -> const std::uint8_t* ;
+    auto encodedSize() const -> std::uint32_t ;
+    
+    // Decodes into output, which must hold the previous buffer for RLEDELTA
+    auto decode(std::vector<std::uint8_t> &output) const -> bool ;
+};
+
+#endif /* ZBufferPacket_hpp */
@@ -20,4 +20,11 @@
 #include "SyncPacket.hpp"
 #include "ErrorPacket.hpp"
 #include "BufferPacket.hpp"
+#include "DatagramPacket.hpp"
+#include "StatsPacket.hpp"
+#include "ManifestPacket.hpp"
+#include "FetchPacket.hpp"
+#include "ChunkPacket.hpp"
+#include "ZBufferPacket.hpp"
+#include "ScenePacket.hpp"
 #endif /* allpackets_hpp */
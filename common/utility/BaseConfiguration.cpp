@@ -12,7 +12,8 @@ auto BaseConfiguration::hasBeenUpdated(const std::filesystem::path &path) const
     if (!std::filesystem::exists(path)){ return false ;}
     auto lastwrite = std::filesystem::last_write_time(path) ;
     
-    if ( std::chrono::duration_cast<std::chrono::seconds>(lastwrite - lastRead).count() > 0 ){
+    // Any change, two saves can land in the same second (and a file can be put back)
+    if (lastwrite != lastRead){
         return true ;
     }
     return false ;
@@ -31,6 +32,7 @@ auto BaseConfiguration::parse(std::istream &input ) -> void  {
             if (!line.empty()) {
                 // We need to process the line
                 auto [key,value] = util::split(line, "=") ;
+                settings[util::upper(key)] += value + "\n"s ;
                 processKeyValue(key, value) ;
             }
         }
@@ -48,6 +50,7 @@ auto BaseConfiguration::load(const std::filesystem::path &path) -> bool {
     if (!input.is_open()) {
         return false ;
     }
+    settings.clear() ;
     beginLoad() ;
     parse(input) ;
     input.close() ;
@@ -65,3 +68,39 @@ auto BaseConfiguration::refresh() -> bool {
     }
     return false ;
 }
+
+// ==================================================================================
+auto BaseConfiguration::refresh(BaseConfiguration &snapshot) -> bool {
+    if (configuration_file.empty() || !hasBeenUpdated(configuration_file)) {
+        return false ;
+    }
+    // Seen, even if it does not read, so we dont keep retrying a bad edit
+    auto ec = std::error_code() ;
+    lastRead = std::filesystem::last_write_time(configuration_file, ec) ;
+    if (!snapshot.load(configuration_file)) {
+        throw std::runtime_error("Unable to process: "s + configuration_file.string());
+    }
+    return true ;
+}
+
+// ==================================================================================
+auto BaseConfiguration::changes(const BaseConfiguration &other) const -> std::set<std::string> {
+    auto rvalue = std::set<std::string>() ;
+    for (const auto &[key,value] : settings) {
+        auto iter = other.settings.find(key) ;
+        if (iter == other.settings.end() || iter->second != value) {
+            rvalue.insert(key) ;
+        }
+    }
+    for (const auto &[key,value] : other.settings) {
+        if (!settings.contains(key)) {
+            rvalue.insert(key) ;
+        }
+    }
+    return rvalue ;
+}
+
+// ==================================================================================
+auto BaseConfiguration::file() const -> const std::filesystem::path & {
+    return configuration_file ;
+}
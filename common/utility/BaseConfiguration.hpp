@@ -5,10 +5,15 @@
 
 #include <istream>
 #include <filesystem>
+#include <map>
+#include <set>
+#include <string>
 
 class BaseConfiguration {
     std::filesystem::path configuration_file ;
     std::filesystem::file_time_type lastRead ;
+    // What each key (upper case) was set to, in file order for the ones that repeat
+    std::map<std::string,std::string> settings ;
     auto hasBeenUpdated(const std::filesystem::path &path) const -> bool ;
     auto parse(std::istream &input ) -> void ;
     
@@ -21,6 +26,13 @@ public:
     
     auto load(const std::filesystem::path &path) -> bool ;
     auto refresh() -> bool ;
+    // If the file changed since we read it, read it into snapshot instead, leaving
+    // this as it was (but for the change being seen). True if there was one and it
+    // read cleanly, throws if it did not
+    auto refresh(BaseConfiguration &snapshot) -> bool ;
+    // The keys set differently (or only) in one or the other
+    auto changes(const BaseConfiguration &other) const -> std::set<std::string> ;
+    auto file() const -> const std::filesystem::path & ;
 };
 
 #endif /* BaseConfiguration_hpp */
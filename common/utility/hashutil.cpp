@@ -0,0 +1,69 @@
+//Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "hashutil.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "strutil.hpp"
+
+using namespace std::string_literals ;
+
+namespace util {
+    //==================================================================================
+    ContentHash::ContentHash():value(OFFSETBASIS) {
+        
+    }
+    
+    //==================================================================================
+    auto ContentHash::clear() -> void {
+        value = OFFSETBASIS ;
+    }
+    
+    //==================================================================================
+    auto ContentHash::update(const std::uint8_t *data, size_t length) -> void {
+        auto current = value ;
+        for (size_t index = 0 ; index < length ; index++) {
+            current ^= data[index] ;
+            current *= PRIME ;
+        }
+        value = current ;
+    }
+    
+    //==================================================================================
+    auto ContentHash::updateFile(const std::filesystem::path &path, std::uintmax_t length) -> bool {
+        auto input = std::ifstream(path.string(),std::ios::binary) ;
+        if (!input.is_open()) {
+            return false ;
+        }
+        auto buffer = std::vector<char>(65536,0) ;
+        auto remaining = length ;
+        while (length == 0 || remaining > 0) {
+            auto amount = static_cast<std::streamsize>(buffer.size()) ;
+            if (length != 0) {
+                amount = static_cast<std::streamsize>(std::min<std::uintmax_t>(remaining, buffer.size())) ;
+            }
+            input.read(buffer.data(), amount) ;
+            auto read = input.gcount() ;
+            if (read <= 0) {
+                break ;
+            }
+            update(reinterpret_cast<const std::uint8_t*>(buffer.data()), static_cast<size_t>(read)) ;
+            remaining -= std::min<std::uintmax_t>(remaining, static_cast<std::uintmax_t>(read)) ;
+        }
+        return length == 0 ? input.eof() : remaining == 0 ;
+    }
+    
+    //==================================================================================
+    auto ContentHash::hash(const std::uint8_t *data, size_t length) -> std::uint64_t {
+        auto hash = ContentHash() ;
+        hash.update(data, length) ;
+        return hash.value ;
+    }
+    
+    //==================================================================================
+    auto ContentHash::name(std::uint64_t value) -> std::string {
+        return util::format("%016llx",static_cast<unsigned long long>(value)) ;
+    }
+}
@@ -0,0 +1,40 @@
+//Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef hashutil_hpp
+#define hashutil_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <filesystem>
+
+namespace util {
+    //==================================================================================
+    // ContentHash
+    // 64 bit FNV-1a, which can be fed incrementally. This names content, it is
+    // not meant to stand up to anyone deliberately building a collision.
+    //==================================================================================
+    struct ContentHash {
+        static constexpr std::uint64_t OFFSETBASIS = 0xcbf29ce484222325ULL ;
+        static constexpr std::uint64_t PRIME = 0x100000001b3ULL ;
+        
+        std::uint64_t value ;
+        
+        ContentHash() ;
+        auto clear() -> void ;
+        auto update(const std::uint8_t *data, size_t length) -> void ;
+        
+        //==================================================================================
+        /// Hashes the contents of a file
+        /// - Parameters:
+        ///     - path: the file to hash
+        ///     - length: the number of bytes from the start to hash (0 is the entire file)
+        /// - Returns: false if the file could not be read
+        auto updateFile(const std::filesystem::path &path, std::uintmax_t length = 0) -> bool ;
+        
+        static auto hash(const std::uint8_t *data, size_t length) -> std::uint64_t ;
+        // The hash as 16 hex digits, how cached content is named
+        static auto name(std::uint64_t value) -> std::string ;
+    };
+}
+#endif /* hashutil_hpp */
@@ -0,0 +1,93 @@
+//Copyright © 2025 Charles Kerr. All rights reserved.
+
+#include "rlecodec.hpp"
+
+#include <algorithm>
+
+using namespace std::string_literals ;
+
+namespace util {
+    //==================================================================================
+    auto RleCodec::encode(const std::uint8_t *data, size_t length, const std::uint8_t *previous) -> std::vector<std::uint8_t> {
+        auto source = std::vector<std::uint8_t>(data, data + length) ;
+        if (previous != nullptr) {
+            for (size_t index = 0 ; index < length ; index++) {
+                source[index] ^= previous[index] ;
+            }
+        }
+        auto encoded = std::vector<std::uint8_t>() ;
+        encoded.reserve(length / 2 + 16) ;
+        size_t index = 0 ;
+        size_t literal = 0 ;      // start of the pending literal block
+        auto flushLiteral = [&](size_t end) {
+            while (literal < end) {
+                auto amount = std::min<size_t>(end - literal, MAXLITERAL) ;
+                encoded.push_back(static_cast<std::uint8_t>(amount - 1)) ;
+                encoded.insert(encoded.end(), source.begin() + literal, source.begin() + literal + amount) ;
+                literal += amount ;
+            }
+        };
+        while (index < length) {
+            auto run = size_t(1) ;
+            while (index + run < length && run < MAXRUN && source[index + run] == source[index]) {
+                run++ ;
+            }
+            if (run >= MINRUN) {
+                flushLiteral(index) ;
+                encoded.push_back(static_cast<std::uint8_t>(run + 125)) ;
+                encoded.push_back(source[index]) ;
+                index += run ;
+                literal = index ;
+            }
+            else {
+                index += run ;
+            }
+        }
+        flushLiteral(length) ;
+        return encoded ;
+    }
+    
+    //==================================================================================
+    auto RleCodec::decode(const std::uint8_t *source, size_t sourceLength, std::uint8_t *output, size_t outputLength, bool delta) -> bool {
+        size_t in = 0 ;
+        size_t out = 0 ;
+        while (in < sourceLength) {
+            auto control = source[in++] ;
+            if (control < MAXLITERAL) {
+                auto amount = static_cast<size_t>(control) + 1 ;
+                if (in + amount > sourceLength || out + amount > outputLength) {
+                    return false ;
+                }
+                if (delta) {
+                    for (size_t index = 0 ; index < amount ; index++) {
+                        output[out + index] ^= source[in + index] ;
+                    }
+                }
+                else {
+                    std::copy(source + in, source + in + amount, output + out) ;
+                }
+                in += amount ;
+                out += amount ;
+            }
+            else {
+                auto amount = static_cast<size_t>(control) - 125 ;
+                if (in >= sourceLength || out + amount > outputLength) {
+                    return false ;
+                }
+                auto value = source[in++] ;
+                if (delta) {
+                    if (value != 0) {
+                        for (size_t index = 0 ; index < amount ; index++) {
+                            output[out + index] ^= value ;
+                        }
+                    }
+                }
+                else {
+                    std::fill(output + out, output + out + amount, value) ;
+                }
+                out += amount ;
+            }
+        }
+        return out == outputLength ;
+    }
+}
@@ -0,0 +1,47 @@
+//Copyright © 2025 Charles Kerr. All rights reserved.
+
+#ifndef rlecodec_hpp
+#define rlecodec_hpp
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace util {
+    //==================================================================================
+    // RleCodec
+    // Byte run length coding for light channel data. Each block starts with a
+    // control byte:
+    //      0 - 127     control + 1 literal bytes follow
+    //      128 - 255   the next byte repeats control - 125 times (3 - 130)
+    // Encoding against the previous frame XORs the two first, so channels that
+    // did not change become runs of zero.
+    //==================================================================================
+    struct RleCodec {
+        static constexpr auto MAXLITERAL = 128 ;
+        static constexpr auto MINRUN = 3 ;
+        static constexpr auto MAXRUN = 130 ;
+        
+        //==================================================================================
+        /// Encodes a frame
+        /// - Parameters:
+        ///     - data: the frame
+        ///     - length: the number of bytes in the frame
+        ///     - previous: the frame to encode against (length bytes), or nullptr
+        /// - Returns: the encoded bytes
+        static auto encode(const std::uint8_t *data, size_t length, const std::uint8_t *previous = nullptr) -> std::vector<std::uint8_t> ;
+        
+        //==================================================================================
+        /// Decodes in place into the output buffer
+        /// - Parameters:
+        ///     - source: the encoded bytes
+        ///     - sourceLength: number of encoded bytes
+        ///     - output: where the frame goes. If delta, it must hold the previous frame.
+        ///     - outputLength: the size of the frame
+        ///     - delta: the frame was encoded against the previous one
+        /// - Returns: false if the encoded data does not exactly fill the frame
+        static auto decode(const std::uint8_t *source, size_t sourceLength, std::uint8_t *output, size_t outputLength, bool delta) -> bool ;
+    };
+}
+#endif /* rlecodec_hpp */
@@ -3,14 +3,68 @@
 #include "timeutil.hpp"
 
 #include <algorithm>
+#include <ctime>
 #include <stdexcept>
 
+#if defined(__linux__)
+#include <sys/timex.h>
+#endif
+
 #include "strutil.hpp"
 
 using namespace std::string_literals ;
 
 //======================================================================
 namespace util {
+    //======================================================================
+    auto clockError() -> std::int64_t {
+#if defined(__linux__)
+        auto value = timex() ;
+        value.modes = 0 ;
+        auto state = ::adjtimex(&value) ;
+        if (state == -1 || state == TIME_ERROR || (value.status & STA_UNSYNC) != 0) {
+            return -1 ;
+        }
+        return static_cast<std::int64_t>(value.esterror) ;
+#else
+        return -1 ;
+#endif
+    }
+    
+    //======================================================================
+    // The next time (after now) the local clock reads hour:minute on
+    // month/day (a month of 0 is today, or tomorrow). mktime sorts out a day
+    // past the end of the month, and daylight savings.
+    static auto nextLocal(const ourclock::time_point &now, int month, int day, int hour, int minute) -> ourclock::time_point {
+        auto time = ourclock::to_time_t(now);
+        tm local ;
+#if defined(_MSC_VER)
+        ::localtime_s(&local, &time);
+#else
+        ::localtime_r(&time, &local);
+#endif
+        for (auto step = 0 ; step < 2 ; step++) {
+            auto when = local ;
+            if (month > 0) {
+                when.tm_mon = month - 1 ;
+                when.tm_mday = day ;
+                when.tm_year += step ;
+            }
+            else {
+                when.tm_mday += step ;
+            }
+            when.tm_hour = hour ;
+            when.tm_min = minute ;
+            when.tm_sec = 0 ;
+            when.tm_isdst = -1 ;
+            auto value = ourclock::from_time_t(std::mktime(&when)) ;
+            if (value > now) {
+                return value ;
+            }
+        }
+        return ourclock::time_point::max() ;
+    }
+    
     //======================================================================
     //======================================================================
     HourMinute::HourMinute():hour(0),minute(0){
@@ -188,7 +242,7 @@ namespace util {
 #if defined(SHOW_STANDALONE)
         return true;
 #endif
-        auto hnow = HourMinute::now() ;
+        auto hnow = HourMinute(now) ;
         auto value = startTime <= hnow ;
         value = value &&  (endTime > hnow );
         return value ;
@@ -203,6 +257,14 @@ namespace util {
         return rvalue ;
     }
     
+    // ===========================================================================================
+    auto HourRange::nextChange(const ourclock::time_point &now) const -> ourclock::time_point {
+#if defined(SHOW_STANDALONE)
+        return ourclock::time_point::max() ;
+#endif
+        return std::min(nextLocal(now, 0, 0, startTime.hour, startTime.minute), nextLocal(now, 0, 0, endTime.hour, endTime.minute)) ;
+    }
+    
     // ===========================================================================================
     auto HourRange::describe() const -> std::string {
         return startTime.describe() + " , "s + endTime.describe() ;
@@ -321,4 +383,13 @@ namespace util {
         }
         return false ;
     }
+    
+    // ===========================================================================================
+    auto MonthRange::nextChange(const ourclock::time_point &now) const -> ourclock::time_point {
+#if defined(SHOW_STANDALONE)
+        return ourclock::time_point::max() ;
+#endif
+        // The end day is in the range, it ends the midnight after
+        return std::min(nextLocal(now, startDay.month, startDay.day, 0, 0), nextLocal(now, endDay.month, endDay.day + 1, 0, 0)) ;
+    }
 }
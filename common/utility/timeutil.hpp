@@ -61,9 +61,17 @@ namespace util {
         return sysTimeToString(ourclock::now(), format);
     }
     
+    //=======================================================================
+    /// The kernel's estimate of how far the system clock may be off (what
+    /// ntp/ptp report through adjtimex)
+    /// - Returns: the estimated error in microseconds, or -1 if the clock is
+    /// not synchronized (or we can not tell on this platform)
+    auto clockError() -> std::int64_t ;
+    
     //======================================================================
+    class HourRange ;
     class HourMinute {
-        
+        friend class HourRange ;
         int hour ;
         int minute ;
         
@@ -115,6 +123,8 @@ namespace util {
         HourRange(const std::string & line ) ;
         auto inRange(const ourclock::time_point &now = ourclock::now() ) const -> bool ;
         auto inRange(const HourMinute &value) const -> bool ;
+        // The next time (after now) it starts or ends
+        auto nextChange(const ourclock::time_point &now = ourclock::now()) const -> ourclock::time_point ;
         
         auto describe() const -> std::string ;
     };
@@ -153,6 +163,8 @@ namespace util {
         MonthRange(const MonthDay &beg, const MonthDay &end);
         MonthRange(const std::string &line) ;
         auto inRange(const ourclock::time_point &now = ourclock::now() ) const -> bool ;
+        // The next midnight (after now) it starts or ends
+        auto nextChange(const ourclock::time_point &now = ourclock::now()) const -> ourclock::time_point ;
     } ;
 }
 
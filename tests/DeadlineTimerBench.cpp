@@ -0,0 +1,120 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+// Compares how late a frame deadline fires on asio::steady_timer (what the
+// light output used) and on DeadlineTimer, over the same run of frames, and
+// prints the lateness percentiles for each. Optionally with threads loading
+// the cpu. Fails if DeadlineTimer misses a frame or fires one early.
+//
+//      DeadlineTimerBench [frames [load threads [spin budget us [period ms]]]]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "asio.hpp"
+
+#include "DeadlineTimer.hpp"
+
+using namespace std::string_literals;
+using steady = std::chrono::steady_clock ;
+
+//======================================================================
+auto report(const std::string &name, std::vector<double> lateness) -> void {
+    if (lateness.empty()) {
+        std::cout << std::left << std::setw(28) << name << "no frames" << std::endl;
+        return ;
+    }
+    std::sort(lateness.begin(), lateness.end()) ;
+    auto percentile = [&lateness](double fraction) {
+        return lateness.at(std::min(lateness.size() - 1, static_cast<std::size_t>(fraction * lateness.size()))) ;
+    };
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1) << "n " << lateness.size() << "  p50 " << std::setw(7) << percentile(0.5) << "  p90 " << std::setw(7) << percentile(0.9) << "  p99 " << std::setw(7) << percentile(0.99) << "  max " << std::setw(7) << lateness.back() << " us late" << std::endl;
+}
+
+//======================================================================
+auto main(int argc, const char * argv[]) -> int {
+    auto frames = argc > 1 ? std::stoi(argv[1]) : 300 ;
+    auto load = argc > 2 ? std::stoi(argv[2]) : 0 ;
+    auto spin = std::chrono::microseconds(argc > 3 ? std::stoi(argv[3]) : static_cast<int>(DeadlineTimer::DEFAULTSPIN.count())) ;
+    auto period = std::chrono::milliseconds(argc > 4 ? std::stoi(argv[4]) : 37) ;
+    
+    auto stop = std::atomic<bool>(false) ;
+    auto hogs = std::vector<std::thread>() ;
+    for (auto count = 0 ; count < load ; count++) {
+        hogs.emplace_back([&stop]() {
+            volatile unsigned value = 0 ;
+            while (!stop.load()) {
+                for (auto step = 0 ; step < 100000 ; step++) {
+                    value = value + step ;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(300)) ;
+            }
+        });
+    }
+    
+    // The light output's old timer
+    {
+        auto io = asio::io_context() ;
+        auto timer = asio::steady_timer(io) ;
+        auto lateness = std::vector<double>() ;
+        auto due = steady::now() + period ;
+        std::function<void(const asio::error_code&)> handler = [&](const asio::error_code &error) {
+            lateness.push_back(std::chrono::duration<double, std::micro>(steady::now() - due).count()) ;
+            if (static_cast<int>(lateness.size()) < frames) {
+                due += period ;
+                timer.expires_at(due) ;
+                timer.async_wait(handler) ;
+            }
+        };
+        timer.expires_at(due) ;
+        timer.async_wait(handler) ;
+        io.run() ;
+        report("asio::steady_timer"s, lateness) ;
+    }
+    
+    auto ok = true ;
+    {
+        auto timer = DeadlineTimer() ;
+        timer.setSpinBudget(spin) ;
+        auto access = std::mutex() ;
+        auto lateness = std::vector<double>() ;
+        auto early = 0 ;
+        timer.setExpired([&](steady::time_point due) {
+            auto late = std::chrono::duration<double, std::micro>(steady::now() - due).count() ;
+            auto lock = std::lock_guard(access) ;
+            early += (late < 0.0 ? 1 : 0) ;
+            lateness.push_back(late) ;
+            return static_cast<int>(lateness.size()) < frames ? due + period : steady::time_point::max() ;
+        });
+        timer.expiresAt(steady::now() + period) ;
+        // Every frame, and a couple of seconds to spare
+        auto giveUp = steady::now() + (period * frames) + std::chrono::seconds(2) ;
+        auto fired = 0 ;
+        while (fired < frames && steady::now() < giveUp) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50)) ;
+            auto lock = std::lock_guard(access) ;
+            fired = static_cast<int>(lateness.size()) ;
+        }
+        timer.cancel() ;
+        auto lock = std::lock_guard(access) ;
+        report("DeadlineTimer spin "s + std::to_string(spin.count()) + " us"s, lateness) ;
+        if (static_cast<int>(lateness.size()) != frames || early != 0) {
+            std::cout << "FAILED: " << lateness.size() << " of " << frames << " frames fired, " << early << " early" << std::endl;
+            ok = false ;
+        }
+    }
+    
+    stop = true ;
+    for (auto &hog : hogs) {
+        hog.join() ;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
@@ -0,0 +1,126 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+// Encodes runs of light frames the way ZBUFFER does (plain, and against the
+// previous frame), decodes them back into a staging buffer, and reports the
+// compression ratio and decode time per frame for each kind of show. Fails
+// if a frame does not decode back to what was encoded, or if a cut short
+// frame decodes at all. FRAMES=n changes how many frames each show runs.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utility/rlecodec.hpp"
+
+using namespace std::string_literals;
+
+//======================================================================
+// Two PRUs of WS2812, 8 KB each
+constexpr auto FRAMESIZE = std::size_t(16384) ;
+
+//======================================================================
+struct Show {
+    std::string name ;
+    // Fills in frame number n
+    std::function<void(std::vector<std::uint8_t>&, int)> frame ;
+};
+
+//======================================================================
+struct Result {
+    std::size_t raw ;
+    std::size_t encoded ;
+    double decodeMicroseconds ;
+    int bad ;
+};
+
+//======================================================================
+auto run(const Show &show, int frames, bool delta) -> Result {
+    auto result = Result{0, 0, 0.0, 0} ;
+    auto previous = std::vector<std::uint8_t>(FRAMESIZE, 0) ;
+    auto current = std::vector<std::uint8_t>(FRAMESIZE, 0) ;
+    // What the output holds, so a delta frame decodes against the last one
+    auto staging = std::vector<std::uint8_t>(FRAMESIZE, 0) ;
+    for (auto number = 0 ; number < frames ; number++) {
+        show.frame(current, number) ;
+        auto coded = util::RleCodec::encode(current.data(), current.size(), delta ? previous.data() : nullptr) ;
+        auto start = std::chrono::steady_clock::now() ;
+        auto ok = util::RleCodec::decode(coded.data(), coded.size(), staging.data(), staging.size(), delta) ;
+        result.decodeMicroseconds += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() ;
+        if (!ok || staging != current) {
+            result.bad += 1 ;
+            staging = current ;
+        }
+        // A frame cut short has to be refused, not half applied
+        if (!coded.empty()) {
+            auto scratch = std::vector<std::uint8_t>(previous) ;
+            if (util::RleCodec::decode(coded.data(), coded.size() - 1, scratch.data(), scratch.size(), delta)) {
+                result.bad += 1 ;
+            }
+        }
+        result.raw += current.size() ;
+        result.encoded += coded.size() ;
+        previous = current ;
+    }
+    result.decodeMicroseconds /= frames ;
+    return result ;
+}
+
+//======================================================================
+auto main(int argc, const char * argv[]) -> int {
+    auto frames = std::getenv("FRAMES") != nullptr ? std::stoi(std::getenv("FRAMES")) : 300 ;
+    auto random = std::mt19937(1) ;
+    auto shows = std::vector<Show>{
+        {"dark"s, [](std::vector<std::uint8_t> &frame, int number) {
+            std::fill(frame.begin(), frame.end(), 0) ;
+        }},
+        {"static scene"s, [](std::vector<std::uint8_t> &frame, int number) {
+            // Strings of one colour each
+            for (auto index = std::size_t(0) ; index < frame.size() ; index++) {
+                frame[index] = static_cast<std::uint8_t>(((index / 150) * 37) + ((index % 3) * 80)) ;
+            }
+        }},
+        {"chase"s, [](std::vector<std::uint8_t> &frame, int number) {
+            std::fill(frame.begin(), frame.end(), 0) ;
+            for (auto pixel = (number % 50) ; (pixel * 3) + 2 < static_cast<int>(frame.size()) ; pixel += 50) {
+                frame[pixel * 3] = 255 ;
+                frame[(pixel * 3) + 1] = 128 ;
+            }
+        }},
+        {"fade"s, [](std::vector<std::uint8_t> &frame, int number) {
+            auto level = static_cast<std::uint8_t>(std::lround(127.5 + (127.5 * std::sin(number / 20.0)))) ;
+            std::fill(frame.begin(), frame.end(), level) ;
+        }},
+        {"twinkle"s, [&random](std::vector<std::uint8_t> &frame, int number) {
+            // About 2% of the channels change each frame
+            auto channel = std::uniform_int_distribution<std::size_t>(0, frame.size() - 1) ;
+            for (auto count = 0 ; count < static_cast<int>(frame.size() / 50) ; count++) {
+                frame[channel(random)] = static_cast<std::uint8_t>(random()) ;
+            }
+        }},
+        {"noise"s, [&random](std::vector<std::uint8_t> &frame, int number) {
+            for (auto &value : frame) {
+                value = static_cast<std::uint8_t>(random()) ;
+            }
+        }},
+    };
+    auto bad = 0 ;
+    std::cout << std::fixed << std::setprecision(3) ;
+    std::cout << std::left << std::setw(14) << "show" << std::setw(8) << "coding" << std::setw(10) << "ratio" << "decode us/frame" << std::endl;
+    for (const auto &show : shows) {
+        for (auto delta : {false, true}) {
+            auto result = run(show, frames, delta) ;
+            auto ratio = static_cast<double>(result.encoded) / static_cast<double>(result.raw) ;
+            std::cout << std::setw(14) << show.name << std::setw(8) << (delta ? "delta"s : "plain"s) << std::setw(10) << ratio << result.decodeMicroseconds << (result.bad != 0 ? "  FAILED ("s + std::to_string(result.bad) + " bad frames)"s : ""s) << std::endl;
+            bad += result.bad ;
+        }
+    }
+    return bad == 0 ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
@@ -0,0 +1,109 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+// Runs SyncDiscipline against simulated SYNC sequences: a local clock that
+// drifts from the server's, SYNCs that arrive with jitter, and some that are
+// delayed enough to look like a jump. Each case checks how many times the
+// output had to step, how far off it stays once it has settled, and that the
+// rate it settles on matches the drift. Exits non zero if a case is outside
+// its limits. SEED=n runs a different sequence, VERBOSE=1 prints every SYNC.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SyncDiscipline.hpp"
+
+using namespace std::string_literals;
+
+//======================================================================
+struct Case {
+    std::string name ;
+    SyncDiscipline::Tuning tuning ;
+    double drift ;          // ppm our clock runs fast
+    double jitter ;         // frames (standard deviation) each SYNC is off by
+    double delayed ;        // fraction of SYNCs that arrive two frames late
+    int interval ;          // frames between SYNCs
+    double initial ;        // frames we start off by
+    bool wholeFrames ;      // a step lands on a whole frame (lights) or exactly (audio)
+    int settle ;            // SYNCs before the limits apply
+    int maxSteps ;          // after the first SYNC (which may always step)
+    double maxError ;       // frames
+    double maxDrift ;       // ppm the settled rate may be off from the drift
+};
+
+//======================================================================
+struct Result {
+    int steps ;
+    double worst ;
+    double rate ;           // ppm, the rate correction averaged once settled
+};
+
+//======================================================================
+auto run(const Case &entry, unsigned seed) -> Result {
+    constexpr auto SYNCS = 600 ;
+    auto discipline = SyncDiscipline() ;
+    discipline.setTuning(entry.tuning) ;
+    auto random = std::mt19937(seed) ;
+    auto noise = std::normal_distribution<double>(0.0, entry.jitter) ;
+    auto chance = std::uniform_real_distribution<double>(0.0, 1.0) ;
+    auto verbose = std::getenv("VERBOSE") != nullptr ;
+    auto local = entry.initial ;
+    auto server = 0.0 ;
+    auto result = Result{0, 0.0, 0.0} ;
+    auto settled = 0 ;
+    for (auto sync = 0 ; sync < SYNCS ; sync++) {
+        auto measured = (local - server) + noise(random) ;
+        // A late SYNC makes us look ahead. The first one is taken as is, there
+        // is nothing yet to hold it against.
+        if (sync > 0 && chance(random) < entry.delayed) {
+            measured += 2.0 ;
+        }
+        if (discipline.update(measured, server) == SyncDiscipline::STEP) {
+            local -= entry.wholeFrames ? std::round(measured) : measured ;
+            result.steps += (sync > 0 ? 1 : 0) ;
+        }
+        if (sync >= entry.settle) {
+            result.worst = std::max(result.worst, std::abs(local - server)) ;
+            result.rate += discipline.rate() ;
+            settled += 1 ;
+        }
+        if (verbose) {
+            std::cout << entry.name << " sync " << sync << " measured " << measured << " error " << (local - server) << " rate " << discipline.rate() << std::endl;
+        }
+        for (auto frame = 0 ; frame < entry.interval ; frame++) {
+            local += (1.0 + (entry.drift * 1e-6)) / (1.0 + discipline.rate()) ;
+            server += 1.0 ;
+        }
+    }
+    result.rate = (settled > 0 ? result.rate / settled : 0.0) * 1e6 ;
+    return result ;
+}
+
+//======================================================================
+auto main(int argc, const char * argv[]) -> int {
+    auto light = SyncDiscipline::Tuning() ;
+    auto audio = SyncDiscipline::Tuning() ;
+    audio.slew = 0.0003 ;
+    // At 37 ms a frame, 27 frames is a SYNC a second
+    auto cases = std::vector<Case>{
+        {"lights, on time"s,            light, 50.0,   0.05, 0.0,  27,  0.0,  true,  40, 0, 0.1,  5.0},
+        {"lights, jittery"s,            light, 50.0,   0.2,  0.05, 27,  0.0,  true,  40, 0, 1.0,  30.0},
+        {"lights, far off at start"s,   light, -80.0,  0.2,  0.05, 27,  12.0, true,  40, 0, 1.0,  50.0},
+        {"lights, sparse syncs"s,       light, 100.0,  0.1,  0.0,  270, 0.0,  true,  20, 0, 0.3,  5.0},
+        {"audio, capped slew"s,         audio, 100.0,  0.05, 0.02, 27,  0.0,  false, 60, 0, 0.1,  10.0},
+        {"audio, far off at start"s,    audio, -100.0, 0.05, 0.02, 27,  8.0,  false, 60, 0, 0.1,  10.0},
+    };
+    auto seed = std::getenv("SEED") != nullptr ? static_cast<unsigned>(std::stoul(std::getenv("SEED"))) : 1u ;
+    auto failed = 0 ;
+    for (const auto &entry : cases) {
+        auto result = run(entry, seed) ;
+        auto ok = result.steps <= entry.maxSteps && result.worst <= entry.maxError && std::abs(result.rate - entry.drift) <= entry.maxDrift ;
+        std::cout << (ok ? "ok     "s : "FAILED "s) << entry.name << ": steps " << result.steps << ", worst settled error " << result.worst << " frames, settled rate " << result.rate << " ppm (drift " << entry.drift << ")" << std::endl;
+        failed += ok ? 0 : 1 ;
+    }
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
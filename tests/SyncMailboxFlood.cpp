@@ -0,0 +1,99 @@
+// Copyright © 2025 Charles Kerr. All rights reserved.
+
+// Floods a SyncMailbox from one thread while another takes from it on a
+// 1 ms tick, the way an output does. Every frame is posted with a stamp
+// made from it, so a torn read shows as a take whose stamp does not match.
+// Checks that no take is torn or goes backwards, that a take never holds
+// up the tick, that the tick keeps getting SYNCs (a take only comes up
+// empty when a post is landing), and that once the posting stops the last
+// post has been taken. Reports how long a take held up the tick.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "SyncMailbox.hpp"
+
+using namespace std::string_literals;
+using steady = std::chrono::steady_clock ;
+
+//======================================================================
+// The stamp posted with a frame
+auto stampOf(double frame) -> steady::time_point {
+    return steady::time_point(std::chrono::duration_cast<steady::duration>(std::chrono::nanoseconds(static_cast<std::int64_t>(frame)))) ;
+}
+
+//======================================================================
+auto main(int argc, const char * argv[]) -> int {
+    constexpr auto TICKS = 1000 ;
+    auto box = SyncMailbox() ;
+    auto stop = std::atomic<bool>(false) ;
+    auto posts = std::atomic<std::int64_t>(0) ;
+    auto flood = std::thread([&box, &stop, &posts]() {
+        auto frame = 1.0 ;
+        while (!stop.load()) {
+            box.post(frame, stampOf(frame)) ;
+            frame += 1.0 ;
+            posts += 1 ;
+        }
+    });
+    
+    auto seen = std::uint64_t(0) ;
+    auto last = 0.0 ;
+    auto taken = 0 ;
+    auto torn = 0 ;
+    auto backwards = 0 ;
+    auto missed = 0 ;
+    auto longestMiss = 0 ;
+    auto waits = std::vector<double>() ;
+    auto next = steady::now() ;
+    for (auto tick = 0 ; tick < TICKS ; tick++) {
+        next += std::chrono::milliseconds(1) ;
+        std::this_thread::sleep_until(next) ;
+        auto frame = 0.0 ;
+        auto when = steady::time_point() ;
+        auto start = steady::now() ;
+        auto got = box.take(seen, frame, when) ;
+        waits.push_back(std::chrono::duration<double, std::micro>(steady::now() - start).count()) ;
+        if (!got) {
+            missed += 1 ;
+            longestMiss = std::max(longestMiss, missed) ;
+            continue ;
+        }
+        missed = 0 ;
+        taken += 1 ;
+        torn += (when != stampOf(frame) ? 1 : 0) ;
+        backwards += (frame < last ? 1 : 0) ;
+        last = frame ;
+    }
+    stop = true ;
+    flood.join() ;
+    
+    // Posting has stopped, so the next take (if the last tick did not
+    // already have it) has to be the last post
+    auto frame = 0.0 ;
+    auto when = steady::time_point() ;
+    if (box.take(seen, frame, when)) {
+        last = frame ;
+    }
+    auto final = seen == box.latest() && last == static_cast<double>(posts.load()) ;
+    
+    std::sort(waits.begin(), waits.end()) ;
+    auto percentile = [&waits](double fraction) {
+        return waits.at(static_cast<std::size_t>(fraction * (waits.size() - 1))) ;
+    };
+    std::cout << "posts " << posts.load() << ", ticks " << TICKS << ", taken " << taken << ", torn " << torn << ", backwards " << backwards << ", longest run of empty ticks " << longestMiss << ", last post taken " << (final ? "yes" : "no") << std::endl;
+    std::cout << "take held the tick (us): p50 " << percentile(0.5) << ", p99 " << percentile(0.99) << ", max " << waits.back() << std::endl;
+    
+    // The limits are loose so a busy machine does not fail it: a take is well
+    // under a microsecond, and a flood only empties the odd tick (more on one
+    // cpu, where the poster can be switched out mid post)
+    auto ok = torn == 0 && backwards == 0 && final && percentile(0.99) < 100.0 && longestMiss < 100 ;
+    std::cout << (ok ? "ok"s : "FAILED"s) << std::endl;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}